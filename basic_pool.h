@@ -0,0 +1,423 @@
+#pragma once
+#ifndef BASIC_POOL_H
+#define BASIC_POOL_H
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <algorithm>
+
+#include "eventcount.h"
+#include "exceptions.h"
+#include "schedulers.h"
+#include "topology.h"
+#include "trace.h"
+#include "worker.h"
+#include "task.h"
+#include "types.h"
+
+namespace tdl {
+
+    /**
+     * @brief   The basic_pool class is a pool of worker threads
+     *          with it's policies chosen at compile time, as an
+     *          alternative to the runtime configured global pool
+     *          (see tdl::set_scheduler() and tdl::set_idle_policy()).
+     * @details The scheduler is stored by value and called directly
+     *          on every submit(), instead of through the type erased
+     *          tdl::scheduler_t. The idle policy and the parking of
+     *          idle workers are inlined into the worker loop (see
+     *          Worker::run()). Any scheduler accepted by
+     *          tdl::set_scheduler() may be used.
+     *          The pool is independent of tdl::initialize(). The pool
+     *          owns it's workers (see tdl::WorkerPool), so Tasks
+     *          executed by the pool may also use tdl::spawn(),
+     *          tdl::submit() and tdl::parallel_for(): the work they
+     *          create stays in the pool, as do continuations and
+     *          successors pushed by the finishing worker. Thread
+     *          affinity is not supported, all Tasks are executed
+     *          by the workers of the pool.
+     */
+    template <class Scheduler = load_balancing_scheduler,
+              class IdlePolicy = static_idle_policy<>>
+    class basic_pool final : public WorkerPool {
+    public:
+        /**
+         * @brief Constructs the pool and starts the workers.
+         * @param The number of workers.
+         *        (default: tdl::get_available_concurrency())
+         * @param The steal mode of the workers. (default: tdl::steal_mode::half)
+         * @param The scheduler instance. (default: Scheduler())
+         */
+        explicit basic_pool(std::size_t worker_count = detail::detect_concurrency().count,
+                            steal_mode mode = steal_mode::half,
+                            Scheduler scheduler = Scheduler())
+            : m_scheduler(std::move(scheduler)),
+              m_stopping(false)
+        {
+            // Creating workers
+            std::size_t count = std::max<std::size_t>(worker_count, 1);
+            for (std::size_t i = 0; i < count; i++) {
+                m_workers.push_back(std::make_shared<Worker>(false, mode));
+                m_workers.back()->set_owner(this, i);
+            }
+
+            // Letting each worker steal from all others
+            for (std::size_t i = 0; i < count; i++) {
+                std::vector<Worker*> victims;
+                for (std::size_t j = 0; j < count; j++) {
+                    if (i != j) victims.push_back(m_workers[j].get());
+                }
+                m_workers[i]->set_victims(std::move(victims), 0, 0);
+            }
+
+            // Starting workers parking on the pool (they never retire)
+            for (const worker_ptr &worker : m_workers) {
+                worker->start(IdlePolicy(), [this](std::chrono::microseconds timeout,
+                                                   std::chrono::microseconds) {
+                    wait_for_work(timeout);
+                    return true;
+                });
+            }
+        }
+
+        /**
+         * @brief Destroys the pool after the workers finished
+         *        the queued Tasks, see shutdown().
+         */
+        ~basic_pool() {
+            shutdown();
+        }
+
+        /** Copying a pool is forbidden. */
+        basic_pool(const basic_pool&) = delete;
+        basic_pool& operator=(const basic_pool&) = delete;
+
+        /**
+         * @brief   Submits a Task to the worker selected by the
+         *          scheduler. May be called from any thread.
+         * @details Tasks with unfinished predecessors are held back,
+         *          and pushed by the worker finishing the last one.
+         * @param   Task to submit.
+         */
+        void submit(const task_ptr &task) override {
+            // Holding back Tasks with unfinished predecessors
+            if (task == nullptr || !task->release_dependency()) return;
+            schedule(task);
+        }
+
+        /**
+         * @brief   Submits a batch of Tasks, as if each was passed
+         *          to submit().
+         * @details The scheduler is called once to select the first
+         *          worker, and the batch is dealt in contiguous
+         *          slices to it and the workers following it.
+         * @param   Tasks to submit.
+         */
+        void submit_bulk(const std::vector<task_ptr> &tasks) override {
+            // Collecting the Tasks ready for execution
+            std::vector<task_ptr> storage;
+            const std::vector<task_ptr> &ready = release_batch(tasks, storage);
+            if (ready.empty()) return;
+
+            // Calling scheduler once, to select the first worker
+            auto selected = detail::invoke_scheduler(m_scheduler,
+                                                     m_workers.begin(),
+                                                     m_workers.end(),
+                                                     ready.front());
+            if (selected == m_workers.end())
+                throw scheduler_exception();
+
+            // Dealing one slice of the batch to each worker
+            std::size_t count   = m_workers.size();
+            std::size_t offset  = selected - m_workers.begin();
+            std::size_t slices  = std::min(ready.size(), count);
+            std::size_t minimum = ready.size() / slices;
+            std::size_t excess  = ready.size() % slices;
+            const task_ptr *begin = ready.data();
+
+            for (std::size_t i = 0; i < slices; i++) {
+                const task_ptr *end = begin + minimum + (i < excess ? 1 : 0);
+                m_workers[(offset + i) % count]->submit(begin, end);
+                begin = end;
+            }
+
+            // Waking up a parked worker for each slice
+            m_idle_workers.notify(slices);
+        }
+
+        /**
+         * @brief   Spawns a Task as a child of the calling Task,
+         *          pushing it to the calling worker.
+         * @details Must be called from a Task executed by the pool,
+         *          otherwise throws tdl::task_context_exception.
+         * @param   Task to spawn.
+         */
+        void spawn(const task_ptr &task) override {
+            if (task == nullptr) return;
+
+            // Spawning the task as a child of the caller
+            Worker *spawner = pool_worker();
+            if (spawner == nullptr || spawner->current_task() == nullptr)
+                throw task_context_exception();
+
+            spawn(task, spawner->current_task());
+        }
+
+        /**
+         * @brief   Spawns a Task as a child of the supplied parent,
+         *          see tdl::detail::spawn_child().
+         * @details Must be called from a Task executed by the pool,
+         *          otherwise throws tdl::task_context_exception.
+         * @param   Task to spawn.
+         * @param   Parent of the task.
+         */
+        void spawn(const task_ptr &task, const task_ptr &parent) override {
+            // Finding worker associated with calling thread
+            Worker *spawner = pool_worker();
+            if (spawner == nullptr)
+                throw task_context_exception();
+
+            // Setting parent of the task
+            task->set_parent(parent);
+            parent->increment_refcount();
+
+            // Holding back Tasks with unfinished predecessors
+            if (!task->release_dependency()) return;
+
+            // Pushing task to the worker
+            detail::trace(trace_event::spawn, task->get_id());
+            spawner->push_task(task);
+            spawner->counters().spawned(1);
+
+            // Waking up a parked worker to steal the new Task
+            m_idle_workers.notify(1);
+        }
+
+        /**
+         * @brief   Spawns a batch of Tasks, as if each was passed
+         *          to spawn().
+         * @details The ready Tasks are pushed to the calling worker
+         *          in a single operation.
+         * @param   Tasks to spawn.
+         */
+        void spawn_bulk(const std::vector<task_ptr> &tasks) override {
+            // Finding worker associated with calling thread
+            Worker *spawner = pool_worker();
+            if (spawner == nullptr || spawner->current_task() == nullptr)
+                throw task_context_exception();
+
+            // Setting parent of the tasks to the caller
+            const task_ptr &parent = spawner->current_task();
+            std::uint32_t children = 0;
+            for (const task_ptr &task : tasks) {
+                if (task == nullptr) continue;
+                task->set_parent(parent);
+                children++;
+            }
+            parent->increment_refcount(children);
+
+            // Collecting the Tasks ready for execution
+            std::vector<task_ptr> storage;
+            const std::vector<task_ptr> &ready = release_batch(tasks, storage);
+            if (ready.empty()) return;
+
+            // Pushing tasks to the worker at once
+            detail::trace(trace_event::spawn, ready.begin(), ready.end());
+            spawner->push_tasks(ready.data(), ready.data() + ready.size());
+            spawner->counters().spawned(ready.size());
+
+            // Waking up parked workers to steal the new Tasks
+            m_idle_workers.notify(ready.size());
+        }
+
+        /**
+         * @brief Submits a Task to the worker with the given index,
+         *        bypassing the scheduler, see tdl::detail::submit_to().
+         * @param Index of the worker in range [0; worker_count()).
+         * @param Task to submit.
+         */
+        void submit_to(std::size_t index, const task_ptr &task) override {
+            // Holding back Tasks with unfinished predecessors
+            if (task == nullptr || !task->release_dependency()) return;
+
+            m_workers[index % m_workers.size()]->submit(task);
+            m_idle_workers.notify(1);
+        }
+
+        /**
+         * @brief Pushes a ready Task to the calling worker if it
+         *        belongs to the pool, otherwise submits it through
+         *        the scheduler. Used for continuations and
+         *        successors, see tdl::detail::push_task().
+         * @param Task to push.
+         */
+        void push_task(const task_ptr &task) override {
+            Worker *worker = pool_worker();
+            if (worker == nullptr) {
+                schedule(task);
+                return;
+            }
+            worker->push_task(task);
+        }
+
+        /**
+         * @brief Returns the index of the calling worker in the
+         *        pool, or tdl::detail::no_worker if the caller is
+         *        not one of it's workers.
+         */
+        std::size_t current_worker_index() const override {
+            Worker *worker = Worker::current();
+            if (worker == nullptr || worker->owner() != this) return detail::no_worker;
+            return worker->index();
+        }
+
+        /**
+         * @brief Returns the number of workers.
+         */
+        std::size_t worker_count() const override {
+            return m_workers.size();
+        }
+
+        /**
+         * @brief Returns a snapshot of the counters of the workers,
+         *        see tdl::stats(). The main entry is unused.
+         */
+        pool_stats stats() const {
+            pool_stats stats;
+            for (const worker_ptr &worker : m_workers) {
+                stats.workers.push_back(worker->stats());
+                detail::accumulate(stats.total, stats.workers.back());
+            }
+            return stats;
+        }
+
+        /**
+         * @brief Returns the latencies recorded by the workers for
+         *        each Task tag, see tdl::latency().
+         */
+        std::map<std::uint32_t, latency_stats> latency() const {
+            std::map<std::uint32_t, latency_stats> stats;
+            for (const worker_ptr &worker : m_workers)
+                worker->collect_latency(stats);
+            return stats;
+        }
+
+        /**
+         * @brief Signals the workers to stop when their queues are
+         *        empty, and joins them. Tasks submitted afterwards
+         *        are not executed.
+         */
+        void shutdown() {
+            // Signalling workers to stop
+            for (const worker_ptr &worker : m_workers) worker->stop();
+
+            // Waking up parked workers
+            m_stopping = true;
+            m_idle_workers.notify_all();
+
+            // Joining with worker threads
+            for (const worker_ptr &worker : m_workers) worker->join();
+        }
+
+    private:
+        /**
+         * @brief Submits a ready Task to the worker selected by
+         *        the scheduler.
+         */
+        void schedule(const task_ptr &task) {
+            // Calling scheduler to select a worker for the task
+            auto selected = detail::invoke_scheduler(m_scheduler,
+                                                     m_workers.begin(),
+                                                     m_workers.end(),
+                                                     task);
+            if (selected == m_workers.end())
+                throw scheduler_exception();
+
+            // Submitting task to the worker
+            (*selected)->submit(task);
+
+            // Waking up a parked worker for the new Task
+            m_idle_workers.notify(1);
+        }
+
+        /**
+         * @brief Releases the submission dependency of each Task
+         *        of a batch, and returns the Tasks ready to be
+         *        queued together. Null and held back Tasks are
+         *        left out. The input is returned if it is ready as
+         *        a whole, otherwise the filtered batch is placed
+         *        in storage.
+         */
+        const std::vector<task_ptr>& release_batch(const std::vector<task_ptr> &tasks,
+                                                   std::vector<task_ptr> &storage) {
+            bool filtered = false;
+            for (std::size_t i = 0; i < tasks.size(); i++) {
+                const task_ptr &task = tasks[i];
+
+                // Keeping ready Tasks together
+                if (task != nullptr && task->release_dependency()) {
+                    if (filtered) storage.push_back(task);
+                    continue;
+                }
+
+                // Copying the Tasks kept so far on the first exception
+                if (!filtered) {
+                    storage.reserve(tasks.size());
+                    storage.assign(tasks.begin(), tasks.begin() + i);
+                    filtered = true;
+                }
+            }
+            return filtered ? storage : tasks;
+        }
+
+        /**
+         * @brief Returns the worker of the calling thread if it
+         *        belongs to the pool, otherwise nullptr.
+         */
+        Worker* pool_worker() const {
+            Worker *worker = Worker::current();
+            return worker != nullptr && worker->owner() == this ? worker : nullptr;
+        }
+
+        /**
+         * @brief Parks the calling worker until new Tasks are
+         *        submitted or spawned, the pool is shut down, or
+         *        the timeout expires.
+         */
+        void wait_for_work(std::chrono::microseconds timeout) {
+            // Registering as a waiter before the final check
+            std::uint32_t key = m_idle_workers.prepare_wait();
+
+            // Checking for work published before the registration
+            if (m_stopping || work_available()) {
+                m_idle_workers.cancel_wait();
+                return;
+            }
+
+            // Parking until notified or timed out
+            m_idle_workers.commit_wait(key, timeout);
+        }
+
+        /**
+         * @brief Returns true if any worker has Tasks in it's queues.
+         */
+        bool work_available() const {
+            for (const worker_ptr &worker : m_workers) {
+                if (worker->task_count() > 0) return true;
+            }
+            return false;
+        }
+
+        workerlist_t             m_workers;
+        Scheduler                m_scheduler;
+        EventCount               m_idle_workers;
+        std::atomic<bool>        m_stopping;
+    };
+
+} // namespace tdl
+
+#endif // BASIC_POOL_H
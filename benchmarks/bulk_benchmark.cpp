@@ -0,0 +1,99 @@
+/*****************************************************************
+ * Measures the cost of queueing a burst of Tasks one by one with
+ * tdl::submit() / tdl::spawn(), compared to tdl::submit_bulk() /
+ * tdl::spawn_bulk(). Reports the time spent queueing, and the
+ * time until all Tasks of the burst have been executed.
+ *
+ * Build together with the library sources (except main.cpp):
+ *   g++ -std=c++14 -O2 -pthread -I.. ../[!m]*.cpp bulk_benchmark.cpp
+ ****************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include "tdl.h"
+
+using namespace std::chrono;
+
+// Benchmark parameters
+constexpr std::size_t burst_size = 50000;
+constexpr std::size_t bursts     = 20;
+
+std::atomic<std::size_t> executed {0};
+
+/** Creates a burst of Tasks counting their executions. */
+std::vector<tdl::task_ptr> make_burst() {
+    std::vector<tdl::task_ptr> tasks;
+    tasks.reserve(burst_size);
+    for (std::size_t i = 0; i < burst_size; i++)
+        tasks.push_back(tdl::discards([]() { executed++; }));
+    return tasks;
+}
+
+/**
+ * Returns the average nanoseconds per Task spent queueing,
+ * and until the burst was executed.
+ */
+template <class Queue>
+std::pair<double, double> measure(Queue queue) {
+    nanoseconds queueing {0}, total {0};
+
+    for (std::size_t i = 0; i < bursts; i++) {
+        std::vector<tdl::task_ptr> tasks = make_burst();
+        executed = 0;
+
+        high_resolution_clock::time_point start = high_resolution_clock::now();
+        queue(tasks);
+        high_resolution_clock::time_point queued = high_resolution_clock::now();
+        while (executed != burst_size) std::this_thread::yield();
+        high_resolution_clock::time_point end = high_resolution_clock::now();
+
+        queueing += duration_cast<nanoseconds>(queued - start);
+        total    += duration_cast<nanoseconds>(end - start);
+    }
+
+    double count = static_cast<double>(burst_size * bursts);
+    return std::make_pair(queueing.count() / count, total.count() / count);
+}
+
+/** Queues the burst from inside a Task, and waits for the Task. */
+template <class Queue>
+void from_task(std::vector<tdl::task_ptr> &tasks, Queue queue) {
+    tdl::task_ptr spawner = tdl::discards([&]() { queue(tasks); });
+    tdl::submit(spawner);
+    spawner->wait();
+}
+
+void report(const char *name, std::pair<double, double> result) {
+    std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(14) << result.first << std::setw(14) << result.second << std::endl;
+}
+
+int main() {
+    tdl::initialize();
+
+    std::cout << std::left << std::setw(24) << "ns/task" << std::right
+              << std::setw(14) << "queueing" << std::setw(14) << "executed" << std::endl;
+
+    report("submit, one by one", measure([](std::vector<tdl::task_ptr> &tasks) {
+        for (auto &task : tasks) tdl::submit(task);
+    }));
+    report("submit_bulk", measure([](std::vector<tdl::task_ptr> &tasks) {
+        tdl::submit_bulk(tasks);
+    }));
+    report("spawn, one by one", measure([](std::vector<tdl::task_ptr> &tasks) {
+        from_task(tasks, [](std::vector<tdl::task_ptr> &burst) {
+            for (auto &task : burst) tdl::spawn(task);
+        });
+    }));
+    report("spawn_bulk", measure([](std::vector<tdl::task_ptr> &tasks) {
+        from_task(tasks, [](std::vector<tdl::task_ptr> &burst) {
+            tdl::spawn_bulk(burst);
+        });
+    }));
+
+    tdl::shutdown();
+    return 0;
+}
@@ -0,0 +1,98 @@
+/*****************************************************************
+ * Measures the size of a Task and the cost of it's completion
+ * path: finishing a Task nobody waits for, creating and finishing
+ * a Task, and the latency between finishing a Task and waking up
+ * a thread blocked in Task::wait().
+ *
+ * Build together with the library sources (except main.cpp):
+ *   g++ -std=c++14 -O2 -pthread -I.. ../[!m]*.cpp completion_benchmark.cpp
+ ****************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include "tdl.h"
+
+using namespace std::chrono;
+
+// Benchmark parameters
+constexpr std::size_t iterations = 1000000;
+constexpr std::size_t wakeups    = 10000;
+
+void report(const char *name, double value, const char *unit) {
+    std::cout << std::left << std::setw(36) << name << std::right
+              << std::setw(12) << std::fixed << std::setprecision(2) << value
+              << " " << unit << std::endl;
+}
+
+/** Returns the nanoseconds per Task to finish prepared Tasks. */
+double measure_completion() {
+    std::vector<tdl::task_ptr> tasks;
+    tasks.reserve(iterations);
+    for (std::size_t i = 0; i < iterations; i++)
+        tasks.emplace_back(new tdl::detail::JoinTask(tdl::join_mode::all));
+
+    high_resolution_clock::time_point start = high_resolution_clock::now();
+    for (auto &task : tasks) task->process();
+    high_resolution_clock::time_point end = high_resolution_clock::now();
+
+    return static_cast<double>(duration_cast<nanoseconds>(end - start).count()) / iterations;
+}
+
+/** Returns the nanoseconds per Task to create, finish and release Tasks. */
+double measure_lifecycle() {
+    high_resolution_clock::time_point start = high_resolution_clock::now();
+    for (std::size_t i = 0; i < iterations; i++)
+        tdl::task_ptr(new tdl::detail::JoinTask(tdl::join_mode::all))->process();
+    high_resolution_clock::time_point end = high_resolution_clock::now();
+
+    return static_cast<double>(duration_cast<nanoseconds>(end - start).count()) / iterations;
+}
+
+/**
+ * Returns the average nanoseconds between finishing a Task and
+ * the return of a waiting thread from Task::wait().
+ */
+double measure_wakeup() {
+    std::vector<tdl::task_ptr> tasks;
+    for (std::size_t i = 0; i < wakeups; i++)
+        tasks.emplace_back(new tdl::detail::JoinTask(tdl::join_mode::all));
+
+    std::atomic<std::size_t> waiting {0};
+    std::vector<high_resolution_clock::time_point> finished(wakeups), woken(wakeups);
+
+    std::thread waiter([&]() {
+        for (std::size_t i = 0; i < wakeups; i++) {
+            waiting = i + 1;
+            tasks[i]->wait();
+            woken[i] = high_resolution_clock::now();
+        }
+    });
+
+    for (std::size_t i = 0; i < wakeups; i++) {
+        // Giving the waiter time to block
+        while (waiting != i + 1) std::this_thread::yield();
+        std::this_thread::sleep_for(microseconds(20));
+
+        finished[i] = high_resolution_clock::now();
+        tasks[i]->process();
+    }
+    waiter.join();
+
+    nanoseconds total {0};
+    for (std::size_t i = 0; i < wakeups; i++) total += duration_cast<nanoseconds>(woken[i] - finished[i]);
+    return static_cast<double>(total.count()) / wakeups;
+}
+
+int main() {
+    report("sizeof(Task) + empty body", sizeof(tdl::detail::JoinTask), "bytes");
+    report("mutex + condition_variable (removed)",
+           sizeof(std::mutex) + sizeof(std::condition_variable), "bytes");
+    report("completion, no waiter", measure_completion(), "ns/task");
+    report("create + completion + release", measure_lifecycle(), "ns/task");
+    report("completion to waiter wakeup", measure_wakeup(), "ns");
+    return 0;
+}
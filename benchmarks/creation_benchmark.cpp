@@ -0,0 +1,93 @@
+/*****************************************************************
+ * Measures the cost of creating (and destroying) callable Tasks
+ * with the inline callable storage of tdl::discards/tdl::returns,
+ * compared to the former std::function + std::bind binding.
+ *
+ * Build together with the library sources (except main.cpp):
+ *   g++ -std=c++14 -O2 -pthread -I.. ../[!m]*.cpp creation_benchmark.cpp
+ ****************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <functional>
+#include "tdl.h"
+
+using namespace std::chrono;
+
+// Benchmark parameters
+constexpr std::size_t iterations = 2000000;
+
+/**
+ * The former callable Task: the Callable is bound
+ * by std::bind and stored in a std::function.
+ */
+class LegacyCallable : public tdl::Task {
+public:
+    LegacyCallable(std::function<void()> function)
+        : m_function(function)
+    {}
+
+private:
+    std::function<void()> m_function;
+
+    virtual void execute() override {
+        m_function();
+    }
+};
+
+template <class Function, class... Args>
+tdl::task_ptr legacy_discards(Function &&function, Args&&... args) {
+    return tdl::task_ptr(new LegacyCallable(std::bind(function, std::forward<Args>(args)...)));
+}
+
+template <class Function, class Result, class... Args>
+tdl::task_ptr legacy_returns(Function&& function, Result &result, Args&&... args) {
+    return legacy_discards([=, &result](){
+       result = function(args...);
+    });
+}
+
+/** Returns the nanoseconds per iteration of the supplied body. */
+template <class Body>
+double measure(Body body) {
+    high_resolution_clock::time_point start = high_resolution_clock::now();
+    for (std::size_t i = 0; i < iterations; i++) body(i);
+    high_resolution_clock::time_point end = high_resolution_clock::now();
+    return static_cast<double>(duration_cast<nanoseconds>(end - start).count()) / iterations;
+}
+
+void report(const std::string &name, double legacy, double current) {
+    std::cout << std::left << std::setw(28) << name << std::right
+              << std::setw(14) << std::fixed << std::setprecision(2) << legacy
+              << std::setw(14) << current << std::endl;
+}
+
+int add(int a, int b) { return a + b; }
+
+int main() {
+    volatile int sink = 0;
+    int result = 0;
+    double payload[4] = {1, 2, 3, 4};
+
+    std::cout << std::left << std::setw(28) << "workload (ns/task)" << std::right
+              << std::setw(14) << "bind+function" << std::setw(14) << "inline" << std::endl;
+
+    report("lambda, no arguments",
+           measure([&](std::size_t i) { legacy_discards([&sink, i]() { sink = i; })->process(); }),
+           measure([&](std::size_t i) { tdl::discards([&sink, i]() { sink = i; })->process(); }));
+
+    report("lambda, 48 byte capture",
+           measure([&](std::size_t i) { legacy_discards([&sink, i, payload]() { sink = i + payload[0]; })->process(); }),
+           measure([&](std::size_t i) { tdl::discards([&sink, i, payload]() { sink = i + payload[0]; })->process(); }));
+
+    report("function, 2 bound arguments",
+           measure([&](std::size_t i) { legacy_discards(add, i, 1)->process(); }),
+           measure([&](std::size_t i) { tdl::discards(add, i, 1)->process(); }));
+
+    report("returns, 2 bound arguments",
+           measure([&](std::size_t i) { legacy_returns(add, result, i, 1)->process(); }),
+           measure([&](std::size_t i) { tdl::returns(add, result, i, 1)->process(); }));
+
+    return 0;
+}
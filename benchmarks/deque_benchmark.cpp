@@ -0,0 +1,109 @@
+/*****************************************************************
+ * Microbenchmark comparing the lock-free tdl::WorkStealingDeque
+ * against the mutex guarded std::deque previously used by Worker.
+ *
+ * Build together with the library sources (except main.cpp):
+ *   g++ -std=c++14 -O2 -pthread -I.. ../[!m]*.cpp deque_benchmark.cpp
+ ****************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include "deque.h"
+
+using namespace std::chrono;
+
+// Benchmark parameters
+constexpr std::size_t operations = 4000000;
+constexpr std::size_t batch_size = 64;
+constexpr std::size_t max_thieves = 3;
+
+/**
+ * The mutex guarded deque formerly used by the Worker:
+ * the owner pushes and pops at the front, thieves pop
+ * from the front under the same lock.
+ */
+class MutexDeque {
+public:
+    void push(void *item) {
+        std::lock_guard<std::mutex> guard(m_guard);
+        m_deque.push_front(item);
+    }
+
+    bool pop(void *&item) {
+        std::lock_guard<std::mutex> guard(m_guard);
+        if (m_deque.empty()) return false;
+        item = m_deque.front();
+        m_deque.pop_front();
+        return true;
+    }
+
+    bool steal(void *&item) {
+        return pop(item);
+    }
+
+private:
+    std::mutex          m_guard;
+    std::deque<void*>   m_deque;
+};
+
+/**
+ * Runs the fork/join pattern on the owner side: pushes a batch
+ * of items then pops them back, while the given number of thieves
+ * continuously steal. Returns owner nanoseconds per operation.
+ */
+template <class Deque>
+double run(std::size_t thieves) {
+    Deque deque;
+    std::atomic<bool> done {false};
+    std::atomic<std::size_t> stolen {0};
+    int payload = 0;
+
+    // Starting thieves
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < thieves; i++) {
+        threads.emplace_back([&]() {
+            void *item = nullptr;
+            std::size_t local = 0;
+            while (!done) {
+                if (deque.steal(item)) local++;
+                else std::this_thread::yield();
+            }
+            stolen += local;
+        });
+    }
+
+    // Owner pushing and popping in batches
+    high_resolution_clock::time_point start = high_resolution_clock::now();
+    void *item = nullptr;
+    for (std::size_t i = 0; i < operations / batch_size; i++) {
+        for (std::size_t j = 0; j < batch_size; j++) deque.push(&payload);
+        for (std::size_t j = 0; j < batch_size; j++) deque.pop(item);
+    }
+    high_resolution_clock::time_point end = high_resolution_clock::now();
+
+    // Stopping thieves
+    done = true;
+    for (auto &thread : threads) thread.join();
+
+    auto elapsed = duration_cast<nanoseconds>(end - start).count();
+    return static_cast<double>(elapsed) / (2 * operations);
+}
+
+int main() {
+    std::cout << "thieves  mutex+deque (ns/op)  work-stealing (ns/op)" << std::endl;
+    for (std::size_t thieves = 0; thieves <= max_thieves; thieves++) {
+        double locked   = run<MutexDeque>(thieves);
+        double lockfree = run<tdl::WorkStealingDeque<void*>>(thieves);
+
+        std::cout << std::setw(7)  << thieves
+                  << std::setw(22) << std::fixed << std::setprecision(2) << locked
+                  << std::setw(23) << lockfree << std::endl;
+    }
+
+    return 0;
+}
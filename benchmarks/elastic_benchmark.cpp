@@ -0,0 +1,69 @@
+/*****************************************************************
+ * Measures the cost of the elastic pool: initialize() (which no
+ * longer starts worker threads), the first Task after start up,
+ * and a burst of Tasks after all workers retired, compared to a
+ * burst while the workers are parked.
+ *
+ * Build together with the library sources (except main.cpp):
+ *   g++ -std=c++14 -O2 -pthread -I.. ../[!m]*.cpp elastic_benchmark.cpp
+ ****************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "tdl.h"
+
+using namespace std::chrono;
+
+// Benchmark parameters
+constexpr std::size_t workers    = 4;
+constexpr std::size_t burst      = 1000;
+constexpr auto        retirement = milliseconds(20);
+
+void report(const char *name, double value, const char *unit) {
+    std::cout << std::left << std::setw(36) << name << std::right
+              << std::setw(12) << std::fixed << std::setprecision(2) << value
+              << " " << unit << std::endl;
+}
+
+/** Returns the microseconds to submit and finish a burst of Tasks. */
+double measure_burst() {
+    std::vector<tdl::task_ptr> tasks;
+    for (std::size_t i = 0; i < burst; i++)
+        tasks.push_back(tdl::discards([]() {}));
+
+    high_resolution_clock::time_point start = high_resolution_clock::now();
+    for (const tdl::task_ptr &task : tasks) tdl::submit(task);
+    for (const tdl::task_ptr &task : tasks) task->wait();
+    high_resolution_clock::time_point end = high_resolution_clock::now();
+
+    return static_cast<double>(duration_cast<nanoseconds>(end - start).count()) / 1000;
+}
+
+int main() {
+    tdl::idle_policy policy;
+    policy.park_timeout   = milliseconds(5);
+    policy.retire_timeout = retirement;
+    tdl::set_worker_count(workers);
+    tdl::set_idle_policy(policy);
+
+    high_resolution_clock::time_point start = high_resolution_clock::now();
+    tdl::initialize();
+    high_resolution_clock::time_point end = high_resolution_clock::now();
+    report("initialize()", duration_cast<nanoseconds>(end - start).count() / 1000.0, "us");
+
+    start = high_resolution_clock::now();
+    tdl::task_ptr first = tdl::discards([]() {});
+    tdl::submit(first);
+    first->wait();
+    end = high_resolution_clock::now();
+    report("first Task after initialize()", duration_cast<nanoseconds>(end - start).count() / 1000.0, "us");
+
+    measure_burst();
+    report("burst, parked workers", measure_burst(), "us");
+
+    std::this_thread::sleep_for(retirement * 4);
+    report("burst, retired workers", measure_burst(), "us");
+    return 0;
+}
@@ -0,0 +1,67 @@
+/*****************************************************************
+ * Measures the CPU time burnt by idle workers, and the latency
+ * between submitting a Task to an idle pool and it's start.
+ *
+ * Usage: idle_benchmark [spin_count] [park_timeout_us]
+ * Passing a huge spin_count keeps workers polling forever.
+ *
+ * Build together with the library sources (except main.cpp):
+ *   g++ -std=c++14 -O2 -pthread -I.. ../[!m]*.cpp idle_benchmark.cpp
+ ****************************************************************/
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <ctime>
+#include <cstdlib>
+#include <algorithm>
+#include <vector>
+#include "tdl.h"
+
+using namespace std::chrono;
+
+// Benchmark parameters
+constexpr std::size_t idle_milliseconds = 1000;
+constexpr std::size_t wakeup_trials = 200;
+
+int main(int argc, char *argv[]) {
+    // Configuring the idle policy from the command line
+    tdl::idle_policy policy;
+    if (argc > 1) policy.spin_count = std::strtoull(argv[1], nullptr, 10);
+    if (argc > 2) policy.park_timeout = microseconds(std::strtoll(argv[2], nullptr, 10));
+    tdl::set_idle_policy(policy);
+    tdl::initialize();
+
+    // Measuring CPU time while the pool is idle
+    std::this_thread::sleep_for(milliseconds(50));
+    std::clock_t cpu_start = std::clock();
+    std::this_thread::sleep_for(milliseconds(idle_milliseconds));
+    std::clock_t cpu_end = std::clock();
+    double cpu_ms = 1000.0 * (cpu_end - cpu_start) / CLOCKS_PER_SEC;
+
+    // Measuring submit-to-start latency of an idle pool
+    std::vector<double> latencies;
+    for (std::size_t i = 0; i < wakeup_trials; i++) {
+        std::this_thread::sleep_for(milliseconds(2));
+
+        std::atomic<long long> started {0};
+        auto task = tdl::discards([&]() {
+            started = duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+        });
+
+        long long submitted = duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+        tdl::submit(task);
+        task->wait();
+
+        latencies.push_back((started - submitted) / 1000.0);
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    std::cout << "workers:            " << tdl::get_worker_count() << std::endl;
+    std::cout << "idle CPU:           " << cpu_ms << " ms per " << idle_milliseconds << " ms" << std::endl;
+    std::cout << "wakeup latency p50: " << latencies[latencies.size() / 2] << " us" << std::endl;
+    std::cout << "wakeup latency p99: " << latencies[latencies.size() * 99 / 100] << " us" << std::endl;
+
+    tdl::shutdown();
+    return 0;
+}
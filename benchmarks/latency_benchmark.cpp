@@ -0,0 +1,77 @@
+/*****************************************************************
+ * Measures the throughput of spawning and executing small Tasks
+ * with latency tracking disabled and enabled, and prints the
+ * recorded queueing delay and execution time percentiles of two
+ * tags: the spawning roots and their children.
+ *
+ * Build together with the library sources (except main.cpp):
+ *   g++ -std=c++14 -O2 -pthread -I.. ../[!m]*.cpp latency_benchmark.cpp
+ ****************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include "tdl.h"
+
+using namespace std::chrono;
+
+// Benchmark parameters
+constexpr std::size_t   roots    = 1000;
+constexpr std::size_t   children = 100;
+constexpr std::uint32_t root_tag  = 1;
+constexpr std::uint32_t child_tag = 2;
+
+void report(const char *name, double value, const char *unit) {
+    std::cout << std::left << std::setw(36) << name << std::right
+              << std::setw(12) << std::fixed << std::setprecision(2) << value
+              << " " << unit << std::endl;
+}
+
+/** Returns the nanoseconds per Task to spawn and execute small Tasks. */
+double measure_throughput() {
+    std::vector<tdl::task_ptr> tasks;
+    for (std::size_t i = 0; i < roots; i++) {
+        tasks.push_back(tdl::discards([]() {
+            for (std::size_t j = 0; j < children; j++) {
+                tdl::task_ptr child = tdl::discards([]() {});
+                child->set_tag(child_tag);
+                tdl::spawn(child);
+            }
+        }));
+        tasks.back()->set_tag(root_tag);
+    }
+
+    high_resolution_clock::time_point start = high_resolution_clock::now();
+    for (const tdl::task_ptr &task : tasks) tdl::submit(task);
+    for (const tdl::task_ptr &task : tasks) task->wait();
+    high_resolution_clock::time_point end = high_resolution_clock::now();
+
+    return static_cast<double>(duration_cast<nanoseconds>(end - start).count()) / (roots * (children + 1));
+}
+
+/** Prints the p50, p99 and p999 of a histogram in microseconds. */
+void print_percentiles(const char *name, const tdl::histogram &histogram) {
+    std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(2);
+    for (double percent : {50.0, 99.0, 99.9})
+        std::cout << std::setw(12) << histogram.percentile(percent).count() / 1000.0;
+    std::cout << "  us  (" << histogram.count() << " tasks)" << std::endl;
+}
+
+int main() {
+    tdl::initialize();
+    measure_throughput();
+    report("spawn + execute, tracking disabled", measure_throughput(), "ns/task");
+
+    tdl::set_latency_tracking(true);
+    report("spawn + execute, tracking enabled", measure_throughput(), "ns/task");
+    tdl::set_latency_tracking(false);
+
+    std::map<std::uint32_t, tdl::latency_stats> latency = tdl::latency();
+    std::cout << std::left << std::setw(24) << "" << std::right
+              << std::setw(12) << "p50" << std::setw(12) << "p99" << std::setw(12) << "p999" << std::endl;
+    print_percentiles("root queueing delay", latency[root_tag].queue_delay);
+    print_percentiles("root execution", latency[root_tag].execution);
+    print_percentiles("child queueing delay", latency[child_tag].queue_delay);
+    print_percentiles("child execution", latency[child_tag].execution);
+    return 0;
+}
@@ -0,0 +1,90 @@
+/*****************************************************************
+ * Compares the runtime configured global pool with tdl::basic_pool
+ * using the same scheduler: the cost of a scheduling decision
+ * through tdl::scheduler_t and through a direct call, and the
+ * throughput of submitting and finishing empty Tasks.
+ *
+ * Build together with the library sources (except main.cpp):
+ *   g++ -std=c++14 -O2 -pthread -I.. ../[!m]*.cpp pool_benchmark.cpp
+ ****************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include "tdl.h"
+
+using namespace std::chrono;
+
+// Benchmark parameters
+constexpr std::size_t decisions = 1000000;
+constexpr std::size_t tasks     = 200000;
+constexpr std::size_t workers   = 4;
+
+using scheduler_type = tdl::power_of_two_scheduler;
+
+void report(const char *name, double value, const char *unit) {
+    std::cout << std::left << std::setw(36) << name << std::right
+              << std::setw(12) << std::fixed << std::setprecision(2) << value
+              << " " << unit << std::endl;
+}
+
+/** Returns the nanoseconds per decision of the scheduler. */
+template <class Function>
+double measure_decisions(const Function &decide) {
+    tdl::workerlist_t list;
+    for (std::size_t i = 0; i < workers; i++)
+        list.push_back(std::make_shared<tdl::Worker>(false));
+    tdl::task_ptr task = tdl::discards([]() {});
+
+    std::size_t checksum = 0;
+    high_resolution_clock::time_point start = high_resolution_clock::now();
+    for (std::size_t i = 0; i < decisions; i++)
+        checksum += decide(list, task) - list.begin();
+    high_resolution_clock::time_point end = high_resolution_clock::now();
+
+    volatile std::size_t sink = checksum;
+    (void)sink;
+    return static_cast<double>(duration_cast<nanoseconds>(end - start).count()) / decisions;
+}
+
+/** Returns the nanoseconds per Task to submit and finish empty Tasks. */
+template <class Submit>
+double measure_throughput(const Submit &submit) {
+    std::vector<tdl::task_ptr> submitted;
+    submitted.reserve(tasks);
+    for (std::size_t i = 0; i < tasks; i++)
+        submitted.push_back(tdl::discards([]() {}));
+
+    high_resolution_clock::time_point start = high_resolution_clock::now();
+    for (const tdl::task_ptr &task : submitted) submit(task);
+    for (const tdl::task_ptr &task : submitted) task->wait();
+    high_resolution_clock::time_point end = high_resolution_clock::now();
+
+    return static_cast<double>(duration_cast<nanoseconds>(end - start).count()) / tasks;
+}
+
+int main() {
+    tdl::scheduler_t erased = tdl::detail::to_scheduler(scheduler_type());
+    report("decision, tdl::scheduler_t", measure_decisions([&](tdl::workerlist_t &list, const tdl::task_ptr &task) {
+        return erased(list.begin(), list.end(), task);
+    }), "ns");
+
+    scheduler_type direct;
+    report("decision, direct call", measure_decisions([&](tdl::workerlist_t &list, const tdl::task_ptr &task) {
+        return tdl::detail::invoke_scheduler(direct, list.begin(), list.end(), task);
+    }), "ns");
+
+    tdl::set_worker_count(workers);
+    tdl::set_scheduler(scheduler_type());
+    tdl::initialize();
+    report("submit + finish, global pool", measure_throughput([](const tdl::task_ptr &task) {
+        tdl::submit(task);
+    }), "ns/task");
+    tdl::shutdown();
+
+    tdl::basic_pool<scheduler_type> pool(workers);
+    report("submit + finish, tdl::basic_pool", measure_throughput([&](const tdl::task_ptr &task) {
+        pool.submit(task);
+    }), "ns/task");
+    return 0;
+}
@@ -0,0 +1,88 @@
+/*****************************************************************
+ * Measures the cost of a scheduling decision of the built-in
+ * schedulers for an increasing number of workers, and the spread
+ * of the resulting queue lengths (largest - smallest queue after
+ * queueing a fixed number of Tasks without executing them). The
+ * Tasks carry one of 256 affinity keys.
+ *
+ * Build together with the library sources (except main.cpp):
+ *   g++ -std=c++14 -O2 -pthread -I.. ../[!m]*.cpp scheduler_benchmark.cpp
+ ****************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <algorithm>
+#include "tdl.h"
+
+using namespace std::chrono;
+
+// Benchmark parameters
+constexpr std::size_t decisions = 1000000;
+constexpr std::size_t queued    = 20000;
+
+/** Returns the nanoseconds per scheduling decision. */
+double measure_cost(tdl::scheduler_t scheduler, tdl::workerlist_t &workers) {
+    tdl::task_ptr task = tdl::discards([]() {});
+    task->set_affinity_key(7);
+    std::size_t checksum = 0;
+    high_resolution_clock::time_point start = high_resolution_clock::now();
+    for (std::size_t i = 0; i < decisions; i++)
+        checksum += scheduler(workers.begin(), workers.end(), task) - workers.begin();
+    high_resolution_clock::time_point end = high_resolution_clock::now();
+
+    volatile std::size_t sink = checksum;
+    (void)sink;
+    return static_cast<double>(duration_cast<nanoseconds>(end - start).count()) / decisions;
+}
+
+/** Returns the spread of queue lengths after queueing Tasks. */
+std::size_t measure_spread(tdl::scheduler_t scheduler, std::size_t count) {
+    tdl::workerlist_t workers;
+    for (std::size_t i = 0; i < count; i++)
+        workers.push_back(std::make_shared<tdl::Worker>(false));
+
+    for (std::size_t i = 0; i < queued; i++) {
+        // Queueing Tasks of varying weight (1 to 4 queue entries)
+        tdl::task_ptr task = tdl::discards([]() {});
+        task->set_affinity_key(i % 256);
+        auto selected = scheduler(workers.begin(), workers.end(), task);
+        std::size_t weight = 1 + tdl::detail::thread_rng().below(4);
+        for (std::size_t j = 0; j < weight; j++)
+            (*selected)->submit(tdl::discards([]() {}));
+    }
+
+    auto bounds = std::minmax_element(workers.begin(), workers.end(),
+                                      [](const tdl::worker_ptr &lhs, const tdl::worker_ptr &rhs) {
+        return lhs->task_count() < rhs->task_count();
+    });
+    return (*bounds.second)->task_count() - (*bounds.first)->task_count();
+}
+
+void report(const std::string &name, tdl::scheduler_t scheduler) {
+    std::cout << std::left << std::setw(26) << name << std::right;
+    for (std::size_t count : {4, 16, 64}) {
+        tdl::workerlist_t workers;
+        for (std::size_t i = 0; i < count; i++)
+            workers.push_back(std::make_shared<tdl::Worker>(false));
+
+        std::cout << std::fixed << std::setprecision(2) << std::setw(10) << measure_cost(scheduler, workers)
+                  << std::setw(8) << measure_spread(scheduler, count);
+    }
+    std::cout << std::endl;
+}
+
+int main() {
+    std::cout << std::left << std::setw(26) << "ns/decision, spread" << std::right;
+    for (std::size_t count : {4, 16, 64})
+        std::cout << std::setw(10) << count << std::setw(8) << "workers";
+    std::cout << std::endl;
+
+    report("load_balancing_scheduler", tdl::detail::to_scheduler(tdl::load_balancing_scheduler()));
+    report("round_robin_scheduler", tdl::detail::to_scheduler(tdl::round_robin_scheduler()));
+    report("random_scheduler", tdl::detail::to_scheduler(tdl::random_scheduler()));
+    report("power_of_two_scheduler", tdl::detail::to_scheduler(tdl::power_of_two_scheduler()));
+    report("least_loaded_scheduler", tdl::detail::to_scheduler(tdl::least_loaded_scheduler()));
+    report("hash_affinity_scheduler", tdl::hash_affinity_scheduler());
+    return 0;
+}
@@ -0,0 +1,65 @@
+/*****************************************************************
+ * Measures the throughput of spawning and executing small Tasks,
+ * and prints the statistics of the workers afterwards. Build it
+ * twice, with and without -DTDL_DISABLE_STATS, to compare the
+ * cost of the counters.
+ *
+ * Build together with the library sources (except main.cpp):
+ *   g++ -std=c++14 -O2 -pthread -I.. ../[!m]*.cpp stats_benchmark.cpp
+ ****************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include "tdl.h"
+
+using namespace std::chrono;
+
+// Benchmark parameters
+constexpr std::size_t roots    = 1000;
+constexpr std::size_t children = 100;
+
+void report(const char *name, double value, const char *unit) {
+    std::cout << std::left << std::setw(36) << name << std::right
+              << std::setw(12) << std::fixed << std::setprecision(2) << value
+              << " " << unit << std::endl;
+}
+
+/** Returns the nanoseconds per Task to spawn and execute small Tasks. */
+double measure_throughput() {
+    std::vector<tdl::task_ptr> tasks;
+    for (std::size_t i = 0; i < roots; i++) {
+        tasks.push_back(tdl::discards([]() {
+            for (std::size_t j = 0; j < children; j++)
+                tdl::spawn(tdl::discards([]() {}));
+        }));
+    }
+
+    high_resolution_clock::time_point start = high_resolution_clock::now();
+    for (const tdl::task_ptr &task : tasks) tdl::submit(task);
+    for (const tdl::task_ptr &task : tasks) task->wait();
+    high_resolution_clock::time_point end = high_resolution_clock::now();
+
+    return static_cast<double>(duration_cast<nanoseconds>(end - start).count()) / (roots * (children + 1));
+}
+
+int main() {
+    tdl::initialize();
+    report(tdl::stats_enabled ? "spawn + execute, with stats" : "spawn + execute, without stats",
+           measure_throughput(), "ns/task");
+
+    tdl::pool_stats stats = tdl::stats();
+    for (std::size_t i = 0; i < stats.workers.size(); i++) {
+        const tdl::worker_stats &worker = stats.workers[i];
+        std::cout << "worker " << std::setw(3) << i
+                  << "  executed " << std::setw(8) << worker.executed
+                  << "  spawned " << std::setw(8) << worker.spawned
+                  << "  submitted " << std::setw(6) << worker.submitted
+                  << "  steals " << std::setw(6) << worker.steals << "/" << worker.steal_attempts
+                  << "  busy " << std::setw(6) << duration_cast<milliseconds>(worker.busy_time).count() << " ms"
+                  << "  idle " << std::setw(6) << duration_cast<milliseconds>(worker.idle_time).count() << " ms"
+                  << "  max depth " << worker.max_queue_depth << std::endl;
+    }
+    report("total executed", static_cast<double>(stats.total.executed), "tasks");
+    return 0;
+}
@@ -0,0 +1,78 @@
+/*****************************************************************
+ * Measures the steal throughput of thieves choosing victims with
+ * the global std::rand(), compared to the per-thread generator of
+ * tdl::detail::thread_rng(), for an increasing number of threads.
+ * Each thief repeatedly picks one of the victim deques and steals
+ * from it, until all deques are empty (half of the deques stay
+ * empty, so failed attempts are included).
+ *
+ * Build together with the library sources (except main.cpp):
+ *   g++ -std=c++14 -O2 -pthread -I.. ../[!m]*.cpp steal_benchmark.cpp
+ ****************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+#include "tdl.h"
+
+using namespace std::chrono;
+
+// Benchmark parameters
+constexpr std::size_t victims         = 16;
+constexpr std::size_t items           = 200000;
+constexpr std::size_t maximum_thieves = 16;
+
+/**
+ * Returns the number of attempts (successful or not) per
+ * microsecond, for the given number of thieves.
+ */
+template <class Choose>
+double measure(std::size_t thieves, Choose choose) {
+    // Filling every second deque
+    tdl::WorkStealingDeque<std::size_t> deques[victims];
+    for (std::size_t i = 0; i < victims; i += 2) {
+        for (std::size_t j = 0; j < items / (victims / 2); j++) deques[i].push(j);
+    }
+
+    std::atomic<std::size_t> remaining {items};
+    std::atomic<std::size_t> attempts {0};
+
+    high_resolution_clock::time_point start = high_resolution_clock::now();
+
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < thieves; t++) {
+        threads.emplace_back([&]() {
+            std::size_t local = 0, item = 0;
+            while (remaining.load(std::memory_order_relaxed) != 0) {
+                local++;
+                if (deques[choose()].steal(item))
+                    remaining.fetch_sub(1, std::memory_order_relaxed);
+            }
+            attempts += local;
+        });
+    }
+    for (auto &thread : threads) thread.join();
+
+    high_resolution_clock::time_point end = high_resolution_clock::now();
+    return static_cast<double>(attempts) / duration_cast<microseconds>(end - start).count();
+}
+
+int main() {
+    std::cout << std::setw(8) << "thieves" << std::setw(22) << "std::rand (att/us)"
+              << std::setw(22) << "thread_rng (att/us)" << std::endl;
+
+    for (std::size_t thieves = 1; thieves <= maximum_thieves; thieves *= 2) {
+        double global = measure(thieves, []() {
+            return static_cast<std::size_t>(std::rand()) % victims;
+        });
+        double local = measure(thieves, []() {
+            return tdl::detail::thread_rng().below(victims);
+        });
+
+        std::cout << std::setw(8) << thieves << std::fixed << std::setprecision(2)
+                  << std::setw(22) << global << std::setw(22) << local << std::endl;
+    }
+    return 0;
+}
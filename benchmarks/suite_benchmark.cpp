@@ -0,0 +1,454 @@
+/*****************************************************************
+ * Runs the standard task runtime workloads against every built-in
+ * scheduler and an increasing number of workers, and prints the
+ * results as CSV, to catch scheduler regressions:
+ *
+ *   fib             recursive Fibonacci, fork/join with a cutoff
+ *   nqueens         N-queens solutions, fork/join per placement
+ *   uts             unbalanced tree search, one Task per node
+ *   skynet          1M leaf Tasks, 10 children per level
+ *   wavefront       2D wavefront DAG of Tasks with dependencies
+ *   submission      Tasks submitted by external threads
+ *   parallel_for/N  parallel_for over N elements (a size sweep)
+ *
+ * Columns: workload, scheduler, workers, median time in ms, speedup
+ * over the same scheduler with 1 worker, and speedup over a serial
+ * implementation (the "serial" rows). Worker counts are the powers
+ * of two up to the maximum, and the maximum. A result differing from
+ * the serial one is reported on stderr, and the exit code is 1.
+ *
+ * Usage: suite_benchmark [max workers] [repetitions]
+ *        (default: the available concurrency, 5 repetitions)
+ *
+ * Build together with the library sources (except main.cpp):
+ *   g++ -std=c++14 -O2 -pthread -I.. ../[!m]*.cpp suite_benchmark.cpp
+ ****************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cmath>
+#include "tdl.h"
+
+using namespace std::chrono;
+
+// Benchmark parameters
+constexpr std::size_t   default_repetitions = 5;
+constexpr unsigned      fib_n               = 30;
+constexpr unsigned      fib_cutoff          = 12;
+constexpr unsigned      queens_n            = 11;
+constexpr unsigned      queens_cutoff       = 3;
+constexpr std::size_t   uts_root_children   = 1000;
+constexpr std::size_t   uts_branching       = 4;
+constexpr std::uint64_t uts_threshold       = 2475;     // Per 10000, expected subtree size 100
+constexpr std::size_t   uts_work            = 32;
+constexpr std::uint64_t skynet_size         = 1000000;
+constexpr std::uint64_t skynet_branching    = 10;
+constexpr std::size_t   wavefront_size      = 48;
+constexpr std::size_t   wavefront_work      = 2000;
+constexpr std::size_t   submitters          = 4;
+constexpr std::size_t   submissions         = 25000;
+constexpr std::size_t   sweep_sizes[]       = {std::size_t(1) << 12, std::size_t(1) << 16, std::size_t(1) << 20};
+
+/** A workload, run for each scheduler and worker count. */
+struct workload {
+    std::string                     name;
+    std::function<void()>           parallel;   // Runs the workload with Tasks
+    std::function<void()>           serial;     // Runs the serial implementation
+    std::function<std::uint64_t()>  checksum;   // Returns the result of the last run
+};
+
+/** A counter Tasks can add to without contention: each thread adds to it's own cache line. */
+class spread_counter {
+public:
+    void add(std::uint64_t value) {
+        m_slots[thread_slot()].value.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    std::uint64_t sum() const {
+        std::uint64_t sum = 0;
+        for (const slot &slot : m_slots) sum += slot.value.load(std::memory_order_relaxed);
+        return sum;
+    }
+
+    void reset() {
+        for (slot &slot : m_slots) slot.value.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr std::size_t slot_count = 64;
+
+    struct alignas(64) slot {
+        std::atomic<std::uint64_t> value {0};
+    };
+
+    static std::size_t thread_slot() {
+        static std::atomic<std::size_t> next_slot {0};
+        thread_local std::size_t slot = next_slot++ % slot_count;
+        return slot;
+    }
+
+    slot m_slots[slot_count];
+};
+
+/** The scheduler under test, called by the one installed in the pool. */
+tdl::scheduler_t scheduler_under_test;
+
+/** Mixes the bits of a value (splitmix64), the unit of work of the workloads. */
+std::uint64_t mix(std::uint64_t value) {
+    value += 0x9E3779B97F4A7C15ull;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+/** Runs a function as a submitted Task, and waits for it and it's children. */
+void run_task(const std::function<void()> &function) {
+    tdl::task_ptr root = tdl::discards(function);
+    tdl::submit(root);
+    root->wait();
+}
+
+/** Runs two functions in parallel, the first one as a spawned Task. */
+template <class Left, class Right>
+void fork_join(Left &&left, Right &&right) {
+    tdl::task_ptr task = tdl::discards(std::forward<Left>(left));
+    tdl::spawn(task);
+    right();
+    task->wait();
+}
+
+/*****************************************************************
+ * Workloads
+ ****************************************************************/
+
+std::uint64_t fib_result;
+
+std::uint64_t fib_serial(unsigned n) {
+    return n < 2 ? n : fib_serial(n - 1) + fib_serial(n - 2);
+}
+
+std::uint64_t fib_parallel(unsigned n) {
+    if (n < fib_cutoff) return fib_serial(n);
+
+    std::uint64_t x = 0, y = 0;
+    fork_join([&]() { x = fib_parallel(n - 1); },
+              [&]() { y = fib_parallel(n - 2); });
+    return x + y;
+}
+
+std::uint64_t queens_result;
+constexpr std::uint32_t queens_mask = (1u << queens_n) - 1;
+
+std::uint64_t queens_serial(unsigned row, std::uint32_t columns, std::uint32_t left, std::uint32_t right) {
+    if (row == queens_n) return 1;
+
+    std::uint64_t count = 0;
+    std::uint32_t free = ~(columns | left | right) & queens_mask;
+    while (free != 0) {
+        std::uint32_t bit = free & (0 - free);
+        free ^= bit;
+        count += queens_serial(row + 1, columns | bit, (left | bit) << 1, (right | bit) >> 1);
+    }
+    return count;
+}
+
+std::uint64_t queens_parallel(unsigned row, std::uint32_t columns, std::uint32_t left, std::uint32_t right) {
+    if (row >= queens_cutoff) return queens_serial(row, columns, left, right);
+
+    // Spawning a Task for each free column
+    std::uint64_t counts[queens_n] = {0};
+    std::vector<tdl::task_ptr> children;
+    std::uint32_t free = ~(columns | left | right) & queens_mask;
+    for (std::size_t i = 0; free != 0; i++) {
+        std::uint32_t bit = free & (0 - free);
+        free ^= bit;
+        children.push_back(tdl::discards([=, &counts]() {
+            counts[i] = queens_parallel(row + 1, columns | bit, (left | bit) << 1, (right | bit) >> 1);
+        }));
+    }
+
+    if (!children.empty()) tdl::spawn_bulk(children);
+    for (const tdl::task_ptr &child : children) child->wait();
+    return std::accumulate(std::begin(counts), std::end(counts), std::uint64_t(0));
+}
+
+spread_counter uts_nodes;
+
+/** Returns the number of children of a UTS node (binomial tree). */
+std::size_t uts_children(std::uint64_t node) {
+    return mix(node) % 10000 < uts_threshold ? uts_branching : 0;
+}
+
+/** Returns the ID of a child of a UTS node. */
+std::uint64_t uts_child(std::uint64_t node, std::size_t index) {
+    std::uint64_t child = node + index + 1;
+    for (std::size_t i = 0; i < uts_work; i++) child = mix(child);
+    return child;
+}
+
+/**
+ * Visits a UTS node, spawning it's children as children of the root:
+ * a Task finishes when it's direct children were executed, so this
+ * way the root finishes with the whole tree.
+ */
+void uts_visit(const tdl::task_ptr &root, std::uint64_t node, std::size_t children) {
+    uts_nodes.add(1);
+    for (std::size_t i = 0; i < children; i++) {
+        std::uint64_t child = uts_child(node, i);
+        std::size_t grandchildren = uts_children(child);
+        tdl::detail::spawn_child(tdl::discards([=]() { uts_visit(root, child, grandchildren); }), root);
+    }
+}
+
+void uts_parallel() {
+    tdl::task_ptr root = tdl::discards([]() {
+        uts_visit(tdl::Worker::current()->current_task(), 0, uts_root_children);
+    });
+    tdl::submit(root);
+    root->wait();
+}
+
+void uts_serial() {
+    // Traversing the tree depth-first
+    std::vector<std::pair<std::uint64_t, std::size_t>> stack {{0, uts_root_children}};
+    while (!stack.empty()) {
+        std::pair<std::uint64_t, std::size_t> node = stack.back();
+        stack.pop_back();
+        uts_nodes.add(1);
+        for (std::size_t i = 0; i < node.second; i++) {
+            std::uint64_t child = uts_child(node.first, i);
+            stack.emplace_back(child, uts_children(child));
+        }
+    }
+}
+
+std::uint64_t skynet_result;
+
+std::uint64_t skynet_serial(std::uint64_t number, std::uint64_t size) {
+    if (size == 1) return number;
+
+    std::uint64_t sum = 0;
+    for (std::uint64_t i = 0; i < skynet_branching; i++)
+        sum += skynet_serial(number + i * (size / skynet_branching), size / skynet_branching);
+    return sum;
+}
+
+std::uint64_t skynet_parallel(std::uint64_t number, std::uint64_t size) {
+    if (size == 1) return number;
+
+    // Spawning the children together, then summing their results
+    std::uint64_t sums[skynet_branching];
+    std::vector<tdl::task_ptr> children;
+    children.reserve(skynet_branching);
+    for (std::uint64_t i = 0; i < skynet_branching; i++) {
+        children.push_back(tdl::discards([=, &sums]() {
+            sums[i] = skynet_parallel(number + i * (size / skynet_branching), size / skynet_branching);
+        }));
+    }
+
+    tdl::spawn_bulk(children);
+    for (const tdl::task_ptr &child : children) child->wait();
+    return std::accumulate(std::begin(sums), std::end(sums), std::uint64_t(0));
+}
+
+std::vector<std::uint64_t> wavefront_grid(wavefront_size * wavefront_size);
+
+/** Computes a block of the grid from it's upper and left neighbours. */
+void wavefront_block(std::size_t row, std::size_t column) {
+    std::uint64_t up   = row > 0 ? wavefront_grid[(row - 1) * wavefront_size + column] : row;
+    std::uint64_t left = column > 0 ? wavefront_grid[row * wavefront_size + column - 1] : column;
+
+    std::uint64_t value = up ^ (left << 1);
+    for (std::size_t i = 0; i < wavefront_work; i++) value = mix(value);
+    wavefront_grid[row * wavefront_size + column] = value;
+}
+
+void wavefront_serial() {
+    for (std::size_t row = 0; row < wavefront_size; row++)
+        for (std::size_t column = 0; column < wavefront_size; column++)
+            wavefront_block(row, column);
+}
+
+void wavefront_parallel() {
+    // Linking each block to it's lower and right neighbours
+    std::vector<tdl::task_ptr> blocks;
+    blocks.reserve(wavefront_size * wavefront_size);
+    for (std::size_t row = 0; row < wavefront_size; row++) {
+        for (std::size_t column = 0; column < wavefront_size; column++) {
+            blocks.push_back(tdl::discards([=]() { wavefront_block(row, column); }));
+            if (row > 0) blocks[(row - 1) * wavefront_size + column]->precede(blocks.back());
+            if (column > 0) blocks[row * wavefront_size + column - 1]->precede(blocks.back());
+        }
+    }
+
+    // Submitting all blocks, they are held back until ready
+    for (const tdl::task_ptr &block : blocks) tdl::submit(block);
+    blocks.back()->wait();
+}
+
+spread_counter submission_count;
+
+void submission_serial() {
+    for (std::size_t i = 0; i < submitters * submissions; i++)
+        tdl::discards([]() { submission_count.add(1); })->process();
+}
+
+void submission_parallel() {
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < submitters; t++) {
+        threads.emplace_back([]() {
+            std::vector<tdl::task_ptr> tasks;
+            tasks.reserve(submissions);
+            for (std::size_t i = 0; i < submissions; i++) {
+                tasks.push_back(tdl::discards([]() { submission_count.add(1); }));
+                tdl::submit(tasks.back());
+            }
+            for (const tdl::task_ptr &task : tasks) task->wait();
+        });
+    }
+    for (std::thread &thread : threads) thread.join();
+}
+
+std::vector<double> sweep_data(sweep_sizes[2]);
+
+void sweep_element(double &value) {
+    value = std::sqrt(static_cast<double>(&value - sweep_data.data()) + value);
+}
+
+std::uint64_t sweep_checksum(std::size_t size) {
+    double sum = std::accumulate(sweep_data.begin(), sweep_data.begin() + size, 0.0);
+    std::fill(sweep_data.begin(), sweep_data.end(), 0.0);
+    return static_cast<std::uint64_t>(sum);
+}
+
+std::vector<workload> make_workloads() {
+    std::vector<workload> workloads {
+        {"fib",
+         []() { run_task([]() { fib_result = fib_parallel(fib_n); }); },
+         []() { fib_result = fib_serial(fib_n); },
+         []() { return fib_result; }},
+        {"nqueens",
+         []() { run_task([]() { queens_result = queens_parallel(0, 0, 0, 0); }); },
+         []() { queens_result = queens_serial(0, 0, 0, 0); },
+         []() { return queens_result; }},
+        {"uts",
+         []() { uts_parallel(); },
+         []() { uts_serial(); },
+         []() { std::uint64_t nodes = uts_nodes.sum(); uts_nodes.reset(); return nodes; }},
+        {"skynet",
+         []() { run_task([]() { skynet_result = skynet_parallel(0, skynet_size); }); },
+         []() { skynet_result = skynet_serial(0, skynet_size); },
+         []() { return skynet_result; }},
+        {"wavefront",
+         []() { wavefront_parallel(); },
+         []() { wavefront_serial(); },
+         []() { return wavefront_grid.back(); }},
+        {"submission",
+         []() { submission_parallel(); },
+         []() { submission_serial(); },
+         []() { std::uint64_t count = submission_count.sum(); submission_count.reset(); return count; }},
+    };
+
+    for (std::size_t size : sweep_sizes) {
+        workloads.push_back({"parallel_for/" + std::to_string(size),
+                             [size]() { tdl::parallel_for(sweep_data.begin(), sweep_data.begin() + size, sweep_element); },
+                             [size]() { std::for_each(sweep_data.begin(), sweep_data.begin() + size, sweep_element); },
+                             [size]() { return sweep_checksum(size); }});
+    }
+    return workloads;
+}
+
+/*****************************************************************
+ * Driver
+ ****************************************************************/
+
+/** Returns the median milliseconds of a function, checking the result of each run. */
+double measure(const workload &load, const std::function<void()> &function,
+               std::size_t repetitions, std::uint64_t expected, bool &valid) {
+    std::vector<double> times;
+    for (std::size_t i = 0; i < std::max<std::size_t>(1, repetitions); i++) {
+        high_resolution_clock::time_point start = high_resolution_clock::now();
+        function();
+        high_resolution_clock::time_point end = high_resolution_clock::now();
+        times.push_back(duration_cast<nanoseconds>(end - start).count() / 1e6);
+
+        if (load.checksum() != expected) valid = false;
+    }
+
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+/** Returns the powers of two up to the maximum, and the maximum. */
+std::vector<std::size_t> worker_counts(std::size_t max_workers) {
+    std::vector<std::size_t> counts;
+    for (std::size_t count = 1; count < max_workers; count *= 2) counts.push_back(count);
+    counts.push_back(max_workers);
+    return counts;
+}
+
+int main(int argc, char *argv[]) {
+    std::size_t max_workers = argc > 1 ? std::stoul(argv[1]) : tdl::get_available_concurrency().count;
+    std::size_t repetitions = argc > 2 ? std::stoul(argv[2]) : default_repetitions;
+    max_workers = std::max<std::size_t>(1, max_workers);
+
+    // Installing a scheduler forwarding to the one under test
+    tdl::set_max_worker_count(max_workers);
+    tdl::set_worker_count(max_workers);
+    tdl::set_scheduler([](tdl::workerlist_t::iterator begin, tdl::workerlist_t::iterator end,
+                          const tdl::task_ptr &task) {
+        return scheduler_under_test(begin, end, task);
+    });
+    tdl::initialize();
+
+    const std::pair<const char*, tdl::scheduler_t> schedulers[] = {
+        {"load_balancing", tdl::detail::to_scheduler(tdl::load_balancing_scheduler())},
+        {"round_robin",    tdl::detail::to_scheduler(tdl::round_robin_scheduler())},
+        {"random",         tdl::detail::to_scheduler(tdl::random_scheduler())},
+        {"power_of_two",   tdl::detail::to_scheduler(tdl::power_of_two_scheduler())},
+        {"least_loaded",   tdl::detail::to_scheduler(tdl::least_loaded_scheduler())},
+        {"hash_affinity",  tdl::hash_affinity_scheduler()},
+    };
+
+    std::cout << "workload,scheduler,workers,time_ms,speedup,serial_speedup" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+    bool all_valid = true;
+
+    for (const workload &load : make_workloads()) {
+        // Measuring the serial implementation for reference
+        load.serial();
+        std::uint64_t expected = load.checksum();
+        bool valid = true;
+        double serial_time = measure(load, load.serial, repetitions, expected, valid);
+        std::cout << load.name << ",serial,1," << serial_time << ",," << 1.0 << std::endl;
+
+        for (const auto &scheduler : schedulers) {
+            scheduler_under_test = scheduler.second;
+            double single_time = 0;
+
+            for (std::size_t count : worker_counts(max_workers)) {
+                tdl::set_worker_count(count);
+                double time = measure(load, load.parallel, repetitions, expected, valid);
+                if (count == 1) single_time = time;
+
+                std::cout << load.name << "," << scheduler.first << "," << count << "," << time << ","
+                          << single_time / time << "," << serial_time / time << std::endl;
+                if (!valid) {
+                    std::cerr << load.name << ": wrong result with the " << scheduler.first
+                              << " scheduler and " << count << " workers" << std::endl;
+                    all_valid = false;
+                    valid = true;
+                }
+            }
+        }
+    }
+
+    tdl::shutdown();
+    return all_valid ? 0 : 1;
+}
@@ -0,0 +1,62 @@
+/*****************************************************************
+ * Measures the throughput of spawning and executing small Tasks
+ * with tracing disabled and enabled, and the time to write the
+ * recorded events as Chrome trace JSON.
+ *
+ * Build together with the library sources (except main.cpp):
+ *   g++ -std=c++14 -O2 -pthread -I.. ../[!m]*.cpp trace_benchmark.cpp
+ ****************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <sstream>
+#include "tdl.h"
+
+using namespace std::chrono;
+
+// Benchmark parameters
+constexpr std::size_t roots    = 1000;
+constexpr std::size_t children = 100;
+
+void report(const char *name, double value, const char *unit) {
+    std::cout << std::left << std::setw(36) << name << std::right
+              << std::setw(12) << std::fixed << std::setprecision(2) << value
+              << " " << unit << std::endl;
+}
+
+/** Returns the nanoseconds per Task to spawn and execute small Tasks. */
+double measure_throughput() {
+    std::vector<tdl::task_ptr> tasks;
+    for (std::size_t i = 0; i < roots; i++) {
+        tasks.push_back(tdl::discards([]() {
+            for (std::size_t j = 0; j < children; j++)
+                tdl::spawn(tdl::discards([]() {}));
+        }));
+    }
+
+    high_resolution_clock::time_point start = high_resolution_clock::now();
+    for (const tdl::task_ptr &task : tasks) tdl::submit(task);
+    for (const tdl::task_ptr &task : tasks) task->wait();
+    high_resolution_clock::time_point end = high_resolution_clock::now();
+
+    return static_cast<double>(duration_cast<nanoseconds>(end - start).count()) / (roots * (children + 1));
+}
+
+int main() {
+    tdl::initialize();
+    measure_throughput();
+    report("spawn + execute, tracing disabled", measure_throughput(), "ns/task");
+
+    tdl::set_tracing(true);
+    report("spawn + execute, tracing enabled", measure_throughput(), "ns/task");
+    tdl::set_tracing(false);
+
+    std::ostringstream trace;
+    high_resolution_clock::time_point start = high_resolution_clock::now();
+    tdl::write_trace(trace);
+    high_resolution_clock::time_point end = high_resolution_clock::now();
+    report("write_trace()", duration_cast<microseconds>(end - start).count() / 1000.0, "ms");
+    report("trace size", trace.str().size() / 1024.0, "KiB");
+    return 0;
+}
@@ -2,12 +2,12 @@
 
 namespace tdl {
 
-    CallableWithoutReturn::CallableWithoutReturn(function_t function)
-        : m_function(function)
-    {}
+    CallableWithoutReturn::~CallableWithoutReturn() {
+        m_operations->destroy(&m_storage);
+    }
 
     void CallableWithoutReturn::execute() {
-        m_function();
+        m_operations->invoke(&m_storage);
     }
 
 } // namespace tdl
@@ -2,10 +2,24 @@
 #ifndef CALLABLES_H
 #define CALLABLES_H
 
+#include <new>
+#include <tuple>
+#include <cstddef>
+#include <utility>
 #include <functional>
+#include <type_traits>
 
 #include "task.h"
 
+/**
+ * Size in bytes of the storage reserved inside callable Tasks
+ * for the bound Callable. Callables that do not fit (or are
+ * over-aligned) are allocated on the heap instead.
+ */
+#ifndef TDL_INLINE_CALLABLE_SIZE
+#define TDL_INLINE_CALLABLE_SIZE 48
+#endif
+
 namespace tdl {
 
     /**
@@ -15,19 +29,63 @@ namespace tdl {
      *        lambdas, functors, etc.) to Tasks.
      *        This particular class is used to bind
      *        Callables without a return type.
+     *        Callables up to TDL_INLINE_CALLABLE_SIZE bytes
+     *        are stored inside the Task object itself, and
+     *        move-only Callables are supported.
      *        See make_task() for details.
      */
     class CallableWithoutReturn : public Task {
     public:
-        using function_t = std::function<void()>;
-
         /**
          * @brief Constructs a CallableWithoutReturn object.
-         * @param Callable object convertible to function_t.
+         * @param Callable object invocable without arguments.
          */
-        CallableWithoutReturn(function_t function);
+        template <class Function, class = typename std::enable_if<
+                  !std::is_base_of<Task, typename std::decay<Function>::type>::value>::type>
+        explicit CallableWithoutReturn(Function &&function);
+
+        /** Destroys the bound Callable. */
+        ~CallableWithoutReturn();
+
     private:
-        function_t m_function;
+        using storage_t = typename std::aligned_storage<TDL_INLINE_CALLABLE_SIZE,
+                                                        alignof(std::max_align_t)>::type;
+
+        /**
+         * @brief The operations struct holds the type-erased
+         *        operations of the bound Callable type.
+         */
+        struct operations {
+            void (*invoke)(void *storage);
+            void (*destroy)(void *storage);
+        };
+
+        /** Operations of Callables stored inline. */
+        template <class Callable>
+        struct inline_operations {
+            static void invoke(void *storage)  { (*static_cast<Callable*>(storage))(); }
+            static void destroy(void *storage) { static_cast<Callable*>(storage)->~Callable(); }
+            static constexpr operations table {&invoke, &destroy};
+        };
+
+        /** Operations of Callables stored on the heap. */
+        template <class Callable>
+        struct heap_operations {
+            static void invoke(void *storage)  { (**static_cast<Callable**>(storage))(); }
+            static void destroy(void *storage) { delete *static_cast<Callable**>(storage); }
+            static constexpr operations table {&invoke, &destroy};
+        };
+
+        /** Stores the Callable inline. */
+        template <class Function>
+        void store(Function &&function, std::true_type);
+
+        /** Stores the Callable on the heap. */
+        template <class Function>
+        void store(Function &&function, std::false_type);
+
+        storage_t           m_storage;
+        const operations   *m_operations;
 
         /**
          * @brief Executes the bound Callable.
@@ -35,6 +93,111 @@ namespace tdl {
         virtual void execute() override;
     };
 
+    template <class Callable>
+    constexpr CallableWithoutReturn::operations CallableWithoutReturn::inline_operations<Callable>::table;
+
+    template <class Callable>
+    constexpr CallableWithoutReturn::operations CallableWithoutReturn::heap_operations<Callable>::table;
+
+    template <class Function, class>
+    CallableWithoutReturn::CallableWithoutReturn(Function &&function) {
+        using callable_t = typename std::decay<Function>::type;
+
+        // Storing the Callable inline if it fits, otherwise on the heap
+        store(std::forward<Function>(function),
+              std::integral_constant<bool, sizeof(callable_t) <= sizeof(storage_t) &&
+                                           alignof(callable_t) <= alignof(storage_t)>());
+    }
+
+    template <class Function>
+    void CallableWithoutReturn::store(Function &&function, std::true_type) {
+        using callable_t = typename std::decay<Function>::type;
+        new (&m_storage) callable_t(std::forward<Function>(function));
+        m_operations = &inline_operations<callable_t>::table;
+    }
+
+    template <class Function>
+    void CallableWithoutReturn::store(Function &&function, std::false_type) {
+        using callable_t = typename std::decay<Function>::type;
+        new (&m_storage) callable_t*(new callable_t(std::forward<Function>(function)));
+        m_operations = &heap_operations<callable_t>::table;
+    }
+
+    namespace detail {
+
+        /**
+         * @brief The bound_callable class stores a Callable
+         *        together with copies of it's arguments, and
+         *        invokes the Callable with them. It replaces
+         *        std::bind for binding Task arguments.
+         */
+        template <class Function, class... Args>
+        class bound_callable {
+        public:
+            template <class F, class... A>
+            explicit bound_callable(F &&function, A&&... args)
+                : m_function(std::forward<F>(function)),
+                  m_arguments(std::forward<A>(args)...)
+            {}
+
+            auto operator()() -> decltype(std::declval<Function&>()(std::declval<Args&>()...)) {
+                return call(std::index_sequence_for<Args...>());
+            }
+
+        private:
+            template <std::size_t... Indices>
+            auto call(std::index_sequence<Indices...>)
+                -> decltype(std::declval<Function&>()(std::declval<Args&>()...))
+            {
+                return m_function(std::get<Indices>(m_arguments)...);
+            }
+
+            Function            m_function;
+            std::tuple<Args...> m_arguments;
+        };
+
+        /**
+         * Callable type stored for Function: member pointers are
+         * wrapped by std::mem_fn, other Callables are decayed.
+         */
+        template <class Function, bool = std::is_member_pointer<Function>::value>
+        struct stored_callable {
+            using type = Function;
+        };
+
+        template <class Function>
+        struct stored_callable<Function, true> {
+            using type = decltype(std::mem_fn(std::declval<Function>()));
+        };
+
+        template <class Function>
+        using callable_t = typename stored_callable<typename std::decay<Function>::type>::type;
+
+        /**
+         * @brief  Returns the supplied Callable itself when there
+         *         are no arguments to bind.
+         */
+        template <class Function>
+        callable_t<Function> bind_arguments(Function &&function) {
+            return callable_t<Function>(std::forward<Function>(function));
+        }
+
+        /**
+         * @brief  Returns a bound_callable storing the supplied
+         *         Callable and copies of the arguments.
+         */
+        template <class Function, class Arg, class... Args>
+        bound_callable<callable_t<Function>, typename std::decay<Arg>::type,
+                       typename std::decay<Args>::type...>
+        bind_arguments(Function &&function, Arg &&arg, Args&&... args) {
+            return bound_callable<callable_t<Function>, typename std::decay<Arg>::type,
+                                  typename std::decay<Args>::type...>(
+                        callable_t<Function>(std::forward<Function>(function)),
+                        std::forward<Arg>(arg), std::forward<Args>(args)...);
+        }
+
+    } // namespace detail
+
 } // namespace tdl
 
 #endif // CALLABLES_H
@@ -0,0 +1,42 @@
+#include "dependencies.h"
+
+#include <algorithm>
+
+namespace tdl {
+
+    namespace detail {
+
+        JoinTask::JoinTask(join_mode mode)
+            : Task(mode)
+        {}
+
+        void JoinTask::execute() {}
+
+    } // namespace detail
+
+    namespace {
+
+        /** Creates a JoinTask succeeding all of the supplied Tasks. */
+        task_ptr join(const std::vector<task_ptr> &tasks, join_mode mode) {
+            task_ptr joined(new detail::JoinTask(mode));
+            for (const task_ptr &task : tasks) {
+                if (task != nullptr) task->precede(joined);
+            }
+            return joined;
+        }
+
+    } // namespace
+
+    task_ptr when_all(const std::vector<task_ptr> &tasks) {
+        return join(tasks, join_mode::all);
+    }
+
+    task_ptr when_any(const std::vector<task_ptr> &tasks) {
+        // Joining no inputs like when_all(), as no input can release it
+        bool empty = std::all_of(tasks.begin(), tasks.end(), [](const task_ptr &task) {
+            return task == nullptr;
+        });
+        return join(tasks, empty ? join_mode::all : join_mode::any);
+    }
+
+} // namespace tdl
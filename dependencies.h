@@ -0,0 +1,66 @@
+#pragma once
+#ifndef DEPENDENCIES_H
+#define DEPENDENCIES_H
+
+#include <vector>
+
+#include "task.h"
+#include "types.h"
+
+namespace tdl {
+
+    namespace detail {
+
+        /**
+         * @brief The JoinTask class is an empty Task used by
+         *        tdl::when_all() and tdl::when_any() to join the
+         *        completion of several predecessors.
+         */
+        class JoinTask final : public Task {
+        public:
+            explicit JoinTask(join_mode mode);
+
+        private:
+            virtual void execute() override;
+        };
+
+    } // namespace detail
+
+    /**
+     * @brief   Creates a Task that finishes when all of the
+     *          supplied Tasks have finished.
+     * @details The returned Task must be submitted (or spawned)
+     *          like any other Task; it is pushed to the worker
+     *          finishing the last input. Successors or a
+     *          continuation can be attached to it, and it can
+     *          be waited for.
+     * @param   The input Tasks.
+     * @return  A tdl::task_ptr to the joining Task.
+     */
+    task_ptr when_all(const std::vector<task_ptr> &tasks);
+
+    /**
+     * @brief   Creates a Task that finishes when the first of
+     *          the supplied Tasks has finished. See when_all()
+     *          for details. Without inputs (or only nullptr
+     *          inputs) the Task finishes once submitted, like
+     *          when_all().
+     * @param   The input Tasks.
+     * @return  A tdl::task_ptr to the joining Task.
+     */
+    task_ptr when_any(const std::vector<task_ptr> &tasks);
+
+    /** Variadic forms of when_all() and when_any(). */
+    template <class... Tasks>
+    task_ptr when_all(const task_ptr &first, const Tasks&... rest) {
+        return when_all(std::vector<task_ptr> {first, rest...});
+    }
+
+    template <class... Tasks>
+    task_ptr when_any(const task_ptr &first, const Tasks&... rest) {
+        return when_any(std::vector<task_ptr> {first, rest...});
+    }
+
+} // namespace tdl
+
+#endif // DEPENDENCIES_H
@@ -0,0 +1,220 @@
+#pragma once
+#ifndef DEQUE_H
+#define DEQUE_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+namespace tdl {
+
+    /**
+     * @brief   The WorkStealingDeque class is a lock-free, growable
+     *          work-stealing deque (Chase & Lev, 2005), using the
+     *          memory orderings of Lê et al. (PPoPP 2013).
+     * @details A single owner thread pushes and pops items at the
+     *          bottom end, while any number of thieves concurrently
+     *          steal items from the top end. The owner never takes
+     *          a lock; it only competes with thieves (using a single
+     *          CAS) for the very last item. Items are stored in a
+     *          circular array, which is doubled when full. Replaced
+     *          arrays are retired and released when the deque is
+     *          destroyed, as thieves might still be reading them.
+     *          The item type must be trivially copyable (for Workers
+     *          it is a raw Task pointer).
+     */
+    template <class T>
+    class WorkStealingDeque final {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "tdl::WorkStealingDeque requires a trivially "
+                      "copyable item type.");
+    public:
+        /**
+         * @brief Constructs an empty WorkStealingDeque.
+         * @param Initial capacity, rounded up to a power of two.
+         */
+        explicit WorkStealingDeque(std::size_t capacity = 64)
+            : m_top(0),
+              m_bottom(0)
+        {
+            std::size_t rounded = 1;
+            while (rounded < capacity) rounded <<= 1;
+
+            m_buffers.emplace_back(new Buffer(rounded));
+            m_buffer.store(m_buffers.back().get(), std::memory_order_relaxed);
+        }
+
+        /** Copying a deque is forbidden. */
+        WorkStealingDeque(const WorkStealingDeque&) = delete;
+        WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+        /**
+         * @brief Pushes an item to the bottom of the deque.
+         *        Must only be called by the owner thread.
+         * @param Item to push.
+         */
+        void push(T item) {
+            std::int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+            std::int64_t top    = m_top.load(std::memory_order_acquire);
+            Buffer *buffer      = m_buffer.load(std::memory_order_relaxed);
+
+            // Growing the circular array when full
+            if (bottom - top > buffer->capacity() - 1)
+                buffer = grow(buffer, top, bottom);
+
+            buffer->put(bottom, item);
+            std::atomic_thread_fence(std::memory_order_release);
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Pushes a batch of items to the bottom of the deque,
+         *        publishing them to thieves at once. Must only be
+         *        called by the owner thread.
+         * @param Number of items to push.
+         * @param Function returning the item with the given index.
+         */
+        template <class Function>
+        void push_bulk(std::size_t count, Function item) {
+            std::int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+            std::int64_t top    = m_top.load(std::memory_order_acquire);
+            Buffer *buffer      = m_buffer.load(std::memory_order_relaxed);
+            std::int64_t size   = static_cast<std::int64_t>(count);
+
+            // Growing the circular array until the batch fits
+            while (bottom - top + size > buffer->capacity())
+                buffer = grow(buffer, top, bottom);
+
+            for (std::int64_t i = 0; i < size; i++)
+                buffer->put(bottom + i, item(static_cast<std::size_t>(i)));
+            std::atomic_thread_fence(std::memory_order_release);
+            m_bottom.store(bottom + size, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief  Pops an item from the bottom of the deque.
+         *         Must only be called by the owner thread.
+         * @param  Reference where the popped item is stored.
+         * @return True if an item was popped, false if empty.
+         */
+        bool pop(T &item) {
+            std::int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+            Buffer *buffer      = m_buffer.load(std::memory_order_relaxed);
+            m_bottom.store(bottom, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::int64_t top    = m_top.load(std::memory_order_relaxed);
+
+            // Restoring bottom if the deque was empty
+            if (top > bottom) {
+                m_bottom.store(bottom + 1, std::memory_order_relaxed);
+                return false;
+            }
+
+            item = buffer->get(bottom);
+            if (top != bottom) return true;
+
+            // Competing with thieves for the last item
+            bool won = m_top.compare_exchange_strong(top, top + 1,
+                                                     std::memory_order_seq_cst,
+                                                     std::memory_order_relaxed);
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return won;
+        }
+
+        /**
+         * @brief  Steals an item from the top of the deque.
+         *         May be called by any thread.
+         * @param  Reference where the stolen item is stored.
+         * @return True if an item was stolen, false if the deque
+         *         was empty or another thread won the race.
+         */
+        bool steal(T &item) {
+            std::int64_t top    = m_top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+            if (top >= bottom) return false;
+
+            Buffer *buffer = m_buffer.load(std::memory_order_acquire);
+            T stolen = buffer->get(top);
+            if (!m_top.compare_exchange_strong(top, top + 1,
+                                               std::memory_order_seq_cst,
+                                               std::memory_order_relaxed))
+                return false;
+
+            item = stolen;
+            return true;
+        }
+
+        /**
+         * @brief Returns the approximate number of items.
+         *        Exact only when called by the owner thread
+         *        without concurrent thieves.
+         */
+        std::size_t size() const {
+            std::int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+            std::int64_t top    = m_top.load(std::memory_order_relaxed);
+            return bottom > top ? static_cast<std::size_t>(bottom - top) : 0;
+        }
+
+        /**
+         * @brief Returns true if the deque appears empty.
+         */
+        bool empty() const {
+            return size() == 0;
+        }
+
+    private:
+        /**
+         * @brief The Buffer struct is a fixed-size circular
+         *        array indexed by the (unbounded) deque indices.
+         */
+        struct Buffer {
+            explicit Buffer(std::size_t size)
+                : m_mask(static_cast<std::int64_t>(size) - 1),
+                  m_slots(new std::atomic<T>[size])
+            {}
+
+            std::int64_t capacity() const {
+                return m_mask + 1;
+            }
+
+            void put(std::int64_t index, T item) {
+                m_slots[index & m_mask].store(item, std::memory_order_relaxed);
+            }
+
+            T get(std::int64_t index) const {
+                return m_slots[index & m_mask].load(std::memory_order_relaxed);
+            }
+
+            std::int64_t                        m_mask;
+            std::unique_ptr<std::atomic<T>[]>   m_slots;
+        };
+
+        /**
+         * @brief Replaces the current array with one of
+         *        double the capacity, copying live items.
+         */
+        Buffer *grow(Buffer *old, std::int64_t top, std::int64_t bottom) {
+            m_buffers.emplace_back(new Buffer(2 * old->capacity()));
+            Buffer *buffer = m_buffers.back().get();
+
+            for (std::int64_t i = top; i < bottom; i++)
+                buffer->put(i, old->get(i));
+
+            m_buffer.store(buffer, std::memory_order_release);
+            return buffer;
+        }
+
+        alignas(64) std::atomic<std::int64_t>   m_top;
+        alignas(64) std::atomic<std::int64_t>   m_bottom;
+        std::atomic<Buffer*>                    m_buffer;
+        std::vector<std::unique_ptr<Buffer>>    m_buffers;
+    };
+
+} // namespace tdl
+
+#endif // DEQUE_H
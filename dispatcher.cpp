@@ -5,9 +5,15 @@ namespace tdl {
 
     Dispatcher::Dispatcher()
         : m_initialized {false},
-          m_scheduler {load_balancing_scheduler()},
-          m_worker_count {std::thread::hardware_concurrency()},
-          m_main_processing {false}
+          m_scheduler {detail::to_scheduler(load_balancing_scheduler())},
+          m_concurrency {detail::detect_concurrency()},
+          m_worker_count {m_concurrency.count},
+          m_max_worker_count {m_concurrency.count},
+          m_running_workers {0},
+          m_steal_mode {steal_mode::half},
+          m_pinning {false},
+          m_victim_policy {victim_policy::hierarchical},
+          m_stopping {false}
     {}
 
     Dispatcher::~Dispatcher() {
@@ -24,13 +30,68 @@ namespace tdl {
     }
 
     void Dispatcher::set_worker_count(std::size_t count) {
-        if (!m_initialized) m_worker_count = count;
+        if (!m_initialized) {
+            m_worker_count = count;
+            return;
+        }
+
+        // Resizing within the created workers
+        std::size_t capacity = m_workers.size() - 1;
+        if (count > capacity) throw worker_count_exception();
+        m_worker_count = std::max<std::size_t>(1, count);
+
+        // Waking up parked workers beyond the new count to retire
+        m_idle_workers.notify_all();
+    }
+
+    void Dispatcher::set_max_worker_count(std::size_t count) {
+        if (!m_initialized) m_max_worker_count = count;
+    }
+
+    std::size_t Dispatcher::get_max_worker_count() const {
+        return m_initialized ? m_workers.size() - 1 : std::max<std::size_t>(m_worker_count, m_max_worker_count);
     }
 
     std::size_t Dispatcher::get_worker_count() const {
         return m_worker_count;
     }
 
+    concurrency_info Dispatcher::get_available_concurrency() const {
+        return m_concurrency;
+    }
+
+    void Dispatcher::set_steal_mode(steal_mode mode) {
+        if (!m_initialized) m_steal_mode = mode;
+    }
+
+    steal_mode Dispatcher::get_steal_mode() const {
+        return m_steal_mode;
+    }
+
+    void Dispatcher::set_idle_policy(idle_policy policy) {
+        if (!m_initialized) m_idle_policy = policy;
+    }
+
+    idle_policy Dispatcher::get_idle_policy() const {
+        return m_idle_policy;
+    }
+
+    void Dispatcher::set_pinning(bool enabled) {
+        if (!m_initialized) m_pinning = enabled;
+    }
+
+    bool Dispatcher::get_pinning() const {
+        return m_pinning;
+    }
+
+    void Dispatcher::set_victim_policy(victim_policy policy) {
+        if (!m_initialized) m_victim_policy = policy;
+    }
+
+    victim_policy Dispatcher::get_victim_policy() const {
+        return m_victim_policy;
+    }
+
     void Dispatcher::initialize() {
         // Checking multiple initialization attempts
         if (m_initialized) return;
@@ -49,21 +110,31 @@ namespace tdl {
         // load balancing, and can not be accessed by the
         // scheduler.
         worker_ptr main_worker = std::make_shared<Worker>(true);
+        main_worker->set_owner(this, detail::no_worker);
         m_workers.push_back(main_worker);
 
-        // Creating workers
-        for (std::size_t i = 0; i < m_worker_count; i++) {
+        // Creating workers up to the maximum count, their
+        // threads are started when Tasks are submitted
+        std::size_t capacity = get_max_worker_count();
+        for (std::size_t i = 0; i < capacity; i++) {
             // Creating new worker
-            worker_ptr new_worker = std::make_shared<Worker>(false);
+            worker_ptr new_worker = std::make_shared<Worker>(false, m_steal_mode, m_idle_policy);
+            new_worker->set_owner(this, i);
 
             // Pushing worker into container
             m_workers.push_back(new_worker);
         }
 
-        // Starting workers
-        for (auto it = ++m_workers.begin(); it != m_workers.end(); it++) {
-            (*it)->start();
+        // Placing workers on the CPUs if pinning is enabled
+        std::vector<cpu_info> placement;
+        if (m_pinning) {
+            std::vector<cpu_info> cpus = detail::detect_topology();
+            for (std::size_t i = 0; i < capacity; i++) {
+                placement.push_back(cpus[i % cpus.size()]);
+                m_workers[i + 1]->set_cpu(placement[i].id);
+            }
         }
+        assign_victims(placement);
 
         // Setting initialization flag
         m_initialized = true;
@@ -74,18 +145,63 @@ namespace tdl {
     }
 
     void Dispatcher::shutdown() {
+        // Skipping if never initialized (no main worker to skip)
+        if (m_workers.empty()) return;
+
         // Signalling workers to stop
         for (auto it = ++m_workers.begin(); it != m_workers.end(); it++) {
             (*it)->stop();
         }
 
+        // Waking up parked workers
+        m_stopping = true;
+        m_idle_workers.notify_all();
+
         // Joining with worker threads
         for (auto it = ++m_workers.begin(); it != m_workers.end(); it++) {
             (*it)->join();
         }
     }
 
-    void Dispatcher::submit(task_ptr task) {
+    void Dispatcher::submit(const task_ptr &task) {
+        // Holding back Tasks with unfinished predecessors
+        if (task->release_dependency())
+            schedule(task);
+    }
+
+    void Dispatcher::submit_bulk(const std::vector<task_ptr> &tasks) {
+        // Collecting the Tasks ready for execution
+        std::vector<task_ptr> storage;
+        const std::vector<task_ptr> &ready = release_batch(tasks, storage, false);
+        if (ready.empty()) return;
+
+        // Calling scheduler once, to select the first worker
+        std::size_t count = m_worker_count.load(std::memory_order_relaxed);
+        auto first = ++m_workers.begin();
+        auto selected = m_scheduler(first, first + count, ready.front());
+        if (selected == first + count)
+            throw scheduler_exception();
+
+        // Dealing one slice of the batch to each worker
+        std::size_t offset  = selected - first;
+        std::size_t slices  = std::min(ready.size(), count);
+        std::size_t minimum = ready.size() / slices;
+        std::size_t excess  = ready.size() % slices;
+        const task_ptr *begin = ready.data();
+
+        for (std::size_t i = 0; i < slices; i++) {
+            const task_ptr *end = begin + minimum + (i < excess ? 1 : 0);
+            Worker &worker = *first[(offset + i) % count];
+            worker.submit(begin, end);
+            activate(worker);
+            begin = end;
+        }
+
+        // Waking up a parked worker for each slice
+        m_idle_workers.notify(slices);
+    }
+
+    void Dispatcher::schedule(const task_ptr &task) {
         // Checking main thread affinity
         if (task->get_thread_affinity() == thread_affinity::main) {
             // Submitting task to main thread worker
@@ -94,28 +210,122 @@ namespace tdl {
         }
 
         // Calling scheduler to select a worker for the task
-        auto selected = m_scheduler(++m_workers.begin(),
-                                    m_workers.end());
+        auto first = ++m_workers.begin();
+        auto last = first + m_worker_count.load(std::memory_order_relaxed);
+        auto selected = m_scheduler(first, last, task);
 
         // Check iterator returned by the scheduler
-        if (selected == m_workers.end())
+        if (selected == last)
             throw scheduler_exception();
 
         // Submitting task to the worker
         (*selected)->submit(task);
+        activate(**selected);
+
+        // Waking up a parked worker for the new Task
+        m_idle_workers.notify(1);
     }
 
-    void Dispatcher::spawn(task_ptr task) {
+    void Dispatcher::spawn(const task_ptr &task) {
+        // Spawning the task as a child of the caller
+        Worker *spawner = current_worker();
+        spawn(spawner, task, spawner->current_task());
+    }
+
+    void Dispatcher::spawn(const task_ptr &task, const task_ptr &parent) {
         // Finding worker associated with calling thread
-        worker_ptr spawner = current_worker();
+        spawn(current_worker(), task, parent);
+    }
 
-        // Setting parent of the task to the caller
-        task_ptr parent = spawner->current_task();
+    void Dispatcher::spawn(Worker *spawner, const task_ptr &task, const task_ptr &parent) {
+        // Setting parent of the task
         task->set_parent(parent);
         parent->increment_refcount();
 
+        // Holding back Tasks with unfinished predecessors
+        if (!task->release_dependency()) return;
+
         // Pushing task to the worker
+        detail::trace(trace_event::spawn, task->get_id());
         spawner->push_task(task);
+        spawner->counters().spawned(1);
+
+        // Waking up a parked worker to steal the new Task
+        m_idle_workers.notify(1);
+        grow();
+    }
+
+    void Dispatcher::spawn_bulk(const std::vector<task_ptr> &tasks) {
+        // Finding worker associated with calling thread
+        Worker *spawner = current_worker();
+
+        // Setting parent of the tasks to the caller
+        const task_ptr &parent = spawner->current_task();
+        parent->increment_refcount(static_cast<std::uint32_t>(tasks.size()));
+        for (const task_ptr &task : tasks) task->set_parent(parent);
+
+        // Collecting the Tasks ready for execution
+        std::vector<task_ptr> storage;
+        const std::vector<task_ptr> &ready = release_batch(tasks, storage,
+                                                           spawner == m_workers.front().get());
+        if (ready.empty()) return;
+
+        // Pushing tasks to the worker at once
+        detail::trace(trace_event::spawn, ready.begin(), ready.end());
+        spawner->push_tasks(ready.data(), ready.data() + ready.size());
+        spawner->counters().spawned(ready.size());
+
+        // Waking up parked workers to steal the new Tasks
+        m_idle_workers.notify(ready.size());
+        grow();
+    }
+
+    void Dispatcher::submit_to(std::size_t index, const task_ptr &task) {
+        // Holding back Tasks with unfinished predecessors
+        if (!task->release_dependency()) return;
+
+        // Submitting task to the selected worker
+        Worker &worker = *m_workers[1 + index % m_worker_count.load(std::memory_order_relaxed)];
+        worker.submit(task);
+        activate(worker);
+
+        // Waking up a single parked worker: the selected one finds
+        // the Task in it's own queue before parking, and a worker
+        // woken instead steals it if the selected one is parked
+        m_idle_workers.notify(1);
+    }
+
+    std::size_t Dispatcher::current_worker_index() const {
+        // Reading the index stored in the worker when it was created
+        Worker *worker = Worker::current();
+        if (worker == nullptr || worker->owner() != this) return detail::no_worker;
+        return worker->index();
+    }
+
+    std::size_t Dispatcher::worker_count() const {
+        return m_worker_count.load(std::memory_order_relaxed);
+    }
+
+    pool_stats Dispatcher::stats() const {
+        pool_stats stats;
+        if (m_workers.empty()) return stats;
+
+        // Reading the counters without stopping the workers
+        stats.main  = m_workers.front()->stats();
+        stats.total = stats.main;
+        for (auto it = ++m_workers.begin(); it != m_workers.end(); it++) {
+            stats.workers.push_back((*it)->stats());
+            detail::accumulate(stats.total, stats.workers.back());
+        }
+        return stats;
+    }
+
+    std::map<std::uint32_t, latency_stats> Dispatcher::latency() const {
+        // Merging the histograms of all workers
+        std::map<std::uint32_t, latency_stats> stats;
+        for (const auto &worker : m_workers)
+            worker->collect_latency(stats);
+        return stats;
     }
 
     void Dispatcher::process_main() {
@@ -123,40 +333,148 @@ namespace tdl {
         if (std::this_thread::get_id() != m_main_thread_id)
             throw wrong_thread_exception();
 
-        // Setting processing flag
-        m_main_processing = true;
-
-        // Processing main thread Tasks
+        // Processing main thread Tasks:
+        // The main worker is registered as the current
+        // worker of the main thread while processing.
         (*m_workers.begin())->do_work();
-
-        // Unsetting processing flag
-        m_main_processing = false;
     }
 
-    worker_ptr Dispatcher::current_worker() {
-        // Finding worker thread with the same id as the calling thread
-        auto it = std::find_if(m_workers.begin(), m_workers.end(), [&](const worker_ptr &element) {
-            return element->get_id() == std::this_thread::get_id();
-        });
-
-        // Check main thread context
-        if (it == m_workers.begin() && !m_main_processing)
-            throw task_context_exception();
+    Worker* Dispatcher::current_worker() {
+        // Loading the worker registered for the calling thread
+        Worker *worker = Worker::current();
 
         // Check task-execution context
-        if (it != m_workers.end()) return *it;
+        if (worker != nullptr) return worker;
         else throw task_context_exception();
     }
 
     worker_ptr Dispatcher::choose_victim() {
-        // Generating index from range [1; worker_count)
-        std::size_t index = 1 + std::rand() % (m_worker_count);
+        // Generating index from range [1; worker_count]
+        std::size_t index = 1 + detail::thread_rng().below(m_worker_count.load(std::memory_order_relaxed));
         return m_workers[index];
     }
 
-    void Dispatcher::push_task(task_ptr task) {
+    bool Dispatcher::wait_for_work(std::chrono::microseconds timeout,
+                                   std::chrono::microseconds idle_time) {
+        // Retiring workers beyond the worker count, and workers
+        // idle for longer than the retire timeout
+        std::size_t index = current_worker_index();
+        bool excess  = index != detail::no_worker && index >= m_worker_count.load(std::memory_order_relaxed);
+        bool expired = m_idle_policy.retire_timeout.count() > 0 && idle_time >= m_idle_policy.retire_timeout;
+        if (!m_stopping && (excess || expired)) {
+            if (!current_worker()->retire()) return true;
+            m_running_workers.fetch_sub(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        // Registering as a waiter before the final check
+        std::uint32_t key = m_idle_workers.prepare_wait();
+
+        // Checking for work published before the registration
+        if (m_stopping || work_available()) {
+            m_idle_workers.cancel_wait();
+            return true;
+        }
+
+        // Parking until notified or timed out
+        m_idle_workers.commit_wait(key, timeout);
+        return true;
+    }
+
+    void Dispatcher::activate(Worker &worker) {
+        if (worker.activate())
+            m_running_workers.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void Dispatcher::grow() {
+        // Checking the demand without modifying shared state
+        std::size_t count = m_worker_count.load(std::memory_order_relaxed);
+        if (!m_initialized || count >= m_workers.size()) return;
+        if (m_running_workers.load(std::memory_order_relaxed) >= count ||
+            m_idle_workers.waiters() > 0)
+            return;
+
+        // Starting the first stopped worker
+        for (std::size_t i = 1; i <= count; i++) {
+            if (m_workers[i]->running()) continue;
+            activate(*m_workers[i]);
+            return;
+        }
+    }
+
+    void Dispatcher::assign_victims(const std::vector<cpu_info> &placement) {
+        // Using the topology only for pinned workers
+        bool hierarchical = !placement.empty() && m_victim_policy == victim_policy::hierarchical;
+        std::size_t capacity = m_workers.size() - 1;
+
+        for (std::size_t i = 0; i < capacity; i++) {
+            // Grouping the other workers by distance
+            std::vector<Worker*> siblings, neighbours, remote;
+            for (std::size_t j = 0; j < capacity; j++) {
+                if (i == j) continue;
+
+                Worker *victim = m_workers[j + 1].get();
+                if (!hierarchical) remote.push_back(victim);
+                else if (same_core(placement[i], placement[j])) siblings.push_back(victim);
+                else if (same_domain(placement[i], placement[j])) neighbours.push_back(victim);
+                else remote.push_back(victim);
+            }
+
+            std::size_t sibling_count   = siblings.size();
+            std::size_t neighbour_count = neighbours.size();
+            siblings.insert(siblings.end(), neighbours.begin(), neighbours.end());
+            siblings.insert(siblings.end(), remote.begin(), remote.end());
+            m_workers[i + 1]->set_victims(std::move(siblings), sibling_count, neighbour_count);
+        }
+    }
+
+    bool Dispatcher::work_available() const {
+        for (auto it = ++m_workers.begin(); it != m_workers.end(); it++) {
+            if ((*it)->task_count() > 0) return true;
+        }
+        return false;
+    }
+
+    const std::vector<task_ptr>& Dispatcher::release_batch(const std::vector<task_ptr> &tasks,
+                                                           std::vector<task_ptr> &storage,
+                                                           bool main_worker) {
+        bool filtered = false;
+        for (std::size_t i = 0; i < tasks.size(); i++) {
+            const task_ptr &task = tasks[i];
+            bool ready = task->release_dependency();
+            bool main = !main_worker && task->get_thread_affinity() == thread_affinity::main;
+
+            // Keeping ready Tasks together
+            if (ready && !main) {
+                if (filtered) storage.push_back(task);
+                continue;
+            }
+
+            // Copying the Tasks kept so far on the first exception
+            if (!filtered) {
+                storage.reserve(tasks.size());
+                storage.assign(tasks.begin(), tasks.begin() + i);
+                filtered = true;
+            }
+
+            // Routing Tasks with main thread affinity to the main worker
+            if (ready) schedule(task);
+        }
+        return filtered ? storage : tasks;
+    }
+
+    void Dispatcher::push_task(const task_ptr &task) {
         // Finding worker associated with calling thread
-        worker_ptr spawner = current_worker();
+        Worker *spawner = Worker::current();
+
+        // Scheduling the task if not called from a worker, or if
+        // it has main thread affinity but the caller is not main
+        if (spawner == nullptr ||
+            (task->get_thread_affinity() == thread_affinity::main &&
+             spawner != m_workers.front().get())) {
+            schedule(task);
+            return;
+        }
 
         // Pushing task to the worker
         spawner->push_task(task);
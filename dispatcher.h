@@ -2,10 +2,13 @@
 #ifndef DISPATCHER_H
 #define DISPATCHER_H
 
+#include <vector>
 #include <random>
 #include <functional>
 #include <algorithm>
 
+#include "eventcount.h"
+#include "topology.h"
 #include "make.h"
 #include "schedulers.h"
 #include "worker.h"
@@ -22,8 +25,9 @@ namespace tdl {
      *        destroyed after main() returns. The Dispatcher
      *        coordinates worker threads and provides the
      *        functionality for the global functions of TDL.
+     *        It owns it's workers as their tdl::WorkerPool.
      */
-    class Dispatcher final {
+    class Dispatcher final : public WorkerPool {
     public:
         /** Constructs the Dispatcher object.*/
         Dispatcher();
@@ -46,6 +50,31 @@ namespace tdl {
          */
         void set_worker_count(std::size_t count);
 
+        /**
+         * See tdl::set_max_worker_count() for details.
+         */
+        void set_max_worker_count(std::size_t count);
+
+        /**
+         * See tdl::set_steal_mode() for details.
+         */
+        void set_steal_mode(steal_mode mode);
+
+        /**
+         * See tdl::set_idle_policy() for details.
+         */
+        void set_idle_policy(idle_policy policy);
+
+        /**
+         * See tdl::set_pinning() for details.
+         */
+        void set_pinning(bool enabled);
+
+        /**
+         * See tdl::set_victim_policy() for details.
+         */
+        void set_victim_policy(victim_policy policy);
+
         /**
          * See tdl::get_scheduler() for details.
          */
@@ -56,6 +85,36 @@ namespace tdl {
          */
         std::size_t get_worker_count() const;
 
+        /**
+         * See tdl::get_max_worker_count() for details.
+         */
+        std::size_t get_max_worker_count() const;
+
+        /**
+         * See tdl::get_available_concurrency() for details.
+         */
+        concurrency_info get_available_concurrency() const;
+
+        /**
+         * See tdl::get_steal_mode() for details.
+         */
+        steal_mode get_steal_mode() const;
+
+        /**
+         * See tdl::get_idle_policy() for details.
+         */
+        idle_policy get_idle_policy() const;
+
+        /**
+         * See tdl::get_pinning() for details.
+         */
+        bool get_pinning() const;
+
+        /**
+         * See tdl::get_victim_policy() for details.
+         */
+        victim_policy get_victim_policy() const;
+
         /**
          * @brief Creates and starts the worker threads,
          *        and configures main thread specific
@@ -76,12 +135,52 @@ namespace tdl {
         /**
          * See tdl::submit() for details.
          */
-        void submit(task_ptr task);
+        void submit(const task_ptr &task) override;
+
+        /**
+         * See tdl::submit_bulk() for details.
+         */
+        void submit_bulk(const std::vector<task_ptr> &tasks) override;
 
         /**
          * See tdl::spawn() for details.
          */
-        void spawn(task_ptr task);
+        void spawn(const task_ptr &task) override;
+
+        /**
+         * See tdl::spawn_bulk() for details.
+         */
+        void spawn_bulk(const std::vector<task_ptr> &tasks) override;
+
+        /**
+         * See tdl::detail::spawn_child() for details.
+         */
+        void spawn(const task_ptr &task, const task_ptr &parent) override;
+
+        /**
+         * See tdl::detail::submit_to() for details.
+         */
+        void submit_to(std::size_t index, const task_ptr &task) override;
+
+        /**
+         * See tdl::detail::current_worker_index() for details.
+         */
+        std::size_t current_worker_index() const override;
+
+        /**
+         * See tdl::get_worker_count() for details.
+         */
+        std::size_t worker_count() const override;
+
+        /**
+         * See tdl::stats() for details.
+         */
+        pool_stats stats() const;
+
+        /**
+         * See tdl::latency() for details.
+         */
+        std::map<std::uint32_t, latency_stats> latency() const;
 
         /**
          * See tdl::process_main() for details.
@@ -91,25 +190,92 @@ namespace tdl {
         /**
          * See tdl::detail::push_task() for details.
          */
-        void push_task(task_ptr task);
+        void push_task(const task_ptr &task) override;
 
         /**
          * See tdl::detail::current_worker() for details.
          */
-        worker_ptr current_worker();
+        Worker* current_worker();
 
         /**
          * See tdl::detail::choose_victim() for details.
          */
         worker_ptr choose_victim();
 
+        /**
+         * See tdl::detail::wait_for_work() for details.
+         */
+        bool wait_for_work(std::chrono::microseconds timeout,
+                           std::chrono::microseconds idle_time);
+
     private:
+        /**
+         * @brief Selects a worker for a Task ready for execution
+         *        using the scheduler, and submits the Task to it.
+         */
+        void schedule(const task_ptr &task);
+
+        /**
+         * @brief Spawns a Task as a child of the supplied parent,
+         *        pushing it to the already resolved worker of the
+         *        calling thread.
+         */
+        void spawn(Worker *spawner, const task_ptr &task, const task_ptr &parent);
+
+        /**
+         * @brief Starts the thread of the worker if it is not
+         *        running (see Worker::activate()).
+         */
+        void activate(Worker &worker);
+
+        /**
+         * @brief Starts a stopped worker for newly spawned Tasks,
+         *        if no worker is parked to steal them and fewer
+         *        workers are running than the worker count.
+         */
+        void grow();
+
+        /**
+         * @brief Returns true if any worker that can be stolen
+         *        from has Tasks in it's queues.
+         */
+        bool work_available() const;
+
+        /**
+         * @brief Sets the victims of each worker ordered by their
+         *        distance, according to the CPUs the workers are
+         *        pinned to (all at the same distance if the
+         *        placement is empty or the policy is random).
+         */
+        void assign_victims(const std::vector<cpu_info> &placement);
+
+        /**
+         * @brief  Releases the submission dependency of each Task
+         *         of a batch, and returns the Tasks ready to be
+         *         queued together. Tasks held back are left out,
+         *         and Tasks with main thread affinity are scheduled
+         *         individually (unless the caller is the main worker).
+         *         The input is returned if it is ready as a whole,
+         *         otherwise the filtered batch is placed in storage.
+         */
+        const std::vector<task_ptr>& release_batch(const std::vector<task_ptr> &tasks,
+                                                   std::vector<task_ptr> &storage,
+                                                   bool main_worker);
+
         bool                     m_initialized;
         workerlist_t             m_workers;
         scheduler_t              m_scheduler;
-        std::size_t              m_worker_count;
+        concurrency_info         m_concurrency;
+        std::atomic<std::size_t> m_worker_count;
+        std::size_t              m_max_worker_count;
+        std::atomic<std::size_t> m_running_workers;
+        steal_mode               m_steal_mode;
+        idle_policy              m_idle_policy;
+        bool                     m_pinning;
+        victim_policy            m_victim_policy;
+        EventCount               m_idle_workers;
+        std::atomic<bool>        m_stopping;
         std::thread::id          m_main_thread_id;
-        bool                     m_main_processing;
     };
 
 } // namespace tdl
@@ -0,0 +1,46 @@
+#include "eventcount.h"
+#include "futex.h"
+
+namespace tdl {
+
+    EventCount::EventCount()
+        : m_waiters(0),
+          m_epoch(0)
+    {}
+
+    std::uint32_t EventCount::prepare_wait() {
+        m_waiters.fetch_add(1, std::memory_order_seq_cst);
+        return m_epoch.load(std::memory_order_seq_cst);
+    }
+
+    void EventCount::cancel_wait() {
+        m_waiters.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    void EventCount::commit_wait(std::uint32_t key, std::chrono::microseconds timeout) {
+        // Parking while no notification has been issued
+        if (m_epoch.load(std::memory_order_seq_cst) == key)
+            detail::futex_wait(m_epoch, key, timeout);
+
+        m_waiters.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    void EventCount::notify(std::size_t count) {
+        // Ordering the published work before reading the waiters
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_waiters.load(std::memory_order_relaxed) == 0) return;
+
+        // Advancing the epoch and waking the parked threads
+        m_epoch.fetch_add(1, std::memory_order_seq_cst);
+        detail::futex_wake(m_epoch, count);
+    }
+
+    void EventCount::notify_all() {
+        notify(static_cast<std::size_t>(-1));
+    }
+
+    std::size_t EventCount::waiters() const {
+        return m_waiters.load(std::memory_order_relaxed);
+    }
+
+} // namespace tdl
@@ -0,0 +1,77 @@
+#pragma once
+#ifndef EVENTCOUNT_H
+#define EVENTCOUNT_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+namespace tdl {
+
+    /**
+     * @brief   The EventCount class lets idle threads park until
+     *          new work is published, without a lost-wakeup race
+     *          and without a lock on the notifying side.
+     * @details A thread about to park calls prepare_wait(), then
+     *          re-checks for work. If there is work it calls
+     *          cancel_wait(), otherwise commit_wait() with the key
+     *          returned by prepare_wait(). Producers publish work
+     *          first, then call notify(). When nobody is parked,
+     *          notify() costs a fence and a load.
+     */
+    class EventCount final {
+    public:
+        /** Constructs an EventCount with no waiters. */
+        EventCount();
+
+        /** Copying an EventCount is forbidden. */
+        EventCount(const EventCount&) = delete;
+        EventCount& operator=(const EventCount&) = delete;
+
+        /**
+         * @brief  Registers the calling thread as a waiter.
+         * @return The key to be passed to commit_wait().
+         */
+        std::uint32_t prepare_wait();
+
+        /**
+         * @brief Unregisters the calling thread after
+         *        prepare_wait(), without parking.
+         */
+        void cancel_wait();
+
+        /**
+         * @brief Parks the calling thread until notified after
+         *        the matching prepare_wait(), or until the timeout
+         *        expires. Unregisters the thread on return.
+         * @param Key returned by prepare_wait().
+         * @param Maximum time to park.
+         */
+        void commit_wait(std::uint32_t key, std::chrono::microseconds timeout);
+
+        /**
+         * @brief Wakes up at most the given number of parked
+         *        threads. Returns immediately if none is parked.
+         * @param Number of threads to wake up.
+         */
+        void notify(std::size_t count);
+
+        /**
+         * @brief Wakes up all parked threads.
+         */
+        void notify_all();
+
+        /**
+         * @brief Returns the number of registered waiters.
+         */
+        std::size_t waiters() const;
+
+    private:
+        std::atomic<std::uint32_t>  m_waiters;
+        std::atomic<std::uint32_t>  m_epoch;
+    };
+
+} // namespace tdl
+
+#endif // EVENTCOUNT_H
@@ -59,6 +59,31 @@ namespace tdl {
         }
     };
 
+    /**
+     * @brief The worker_count_exception class is used
+     *        to indicate when the worker count is set above
+     *        tdl::get_max_worker_count() after initialization.
+     */
+    class worker_count_exception final : public std::exception {
+    public:
+        virtual const char *what() const noexcept override {
+            return "tdl::worker_count_exception: Worker count exceeds the "
+                   "maximum worker count set before initialization.";
+        }
+    };
+
+    /**
+     * @brief The graph_exception class is used to
+     *        indicate when a Task passed to a tdl::graph
+     *        is not a node of the graph.
+     */
+    class graph_exception final : public std::exception {
+    public:
+        virtual const char *what() const noexcept override {
+            return "tdl::graph_exception: The supplied task is not "
+                   "a node of the graph.";
+        }
+    };
 
 
 } // namespace tdl
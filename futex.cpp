@@ -0,0 +1,90 @@
+#include "futex.h"
+
+#include <climits>
+
+#if defined(__linux__)
+#include <ctime>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#else
+#include <mutex>
+#include <condition_variable>
+#endif
+
+namespace tdl {
+
+    namespace detail {
+
+#if defined(__linux__)
+
+        void futex_wait(std::atomic<std::uint32_t> &word,
+                        std::uint32_t expected,
+                        std::chrono::microseconds timeout)
+        {
+            // Converting the relative timeout
+            timespec duration {};
+            timespec *duration_ptr = nullptr;
+            if (timeout != std::chrono::microseconds::max()) {
+                duration.tv_sec  = static_cast<time_t>(timeout.count() / 1000000);
+                duration.tv_nsec = static_cast<long>(timeout.count() % 1000000) * 1000;
+                duration_ptr = &duration;
+            }
+
+            syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word),
+                    FUTEX_WAIT_PRIVATE, expected, duration_ptr, nullptr, 0);
+        }
+
+        void futex_wake(std::atomic<std::uint32_t> &word, std::size_t count) {
+            int waking = count > INT_MAX ? INT_MAX : static_cast<int>(count);
+            syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word),
+                    FUTEX_WAKE_PRIVATE, waking, nullptr, nullptr, 0);
+        }
+
+#else
+
+        namespace {
+
+            /**
+             * @brief The bucket struct pairs a mutex and a condition
+             *        variable shared by all words hashing to it.
+             */
+            struct bucket {
+                std::mutex              mutex;
+                std::condition_variable condition;
+            };
+
+            bucket& bucket_of(const void *address) {
+                static bucket s_buckets[64];
+                std::uintptr_t key = reinterpret_cast<std::uintptr_t>(address);
+                return s_buckets[(key >> 4) % 64];
+            }
+
+        } // namespace
+
+        void futex_wait(std::atomic<std::uint32_t> &word,
+                        std::uint32_t expected,
+                        std::chrono::microseconds timeout)
+        {
+            bucket &slot = bucket_of(&word);
+            std::unique_lock<std::mutex> lock(slot.mutex);
+            if (word.load() != expected) return;
+
+            if (timeout == std::chrono::microseconds::max())
+                slot.condition.wait(lock);
+            else
+                slot.condition.wait_for(lock, timeout);
+        }
+
+        void futex_wake(std::atomic<std::uint32_t> &word, std::size_t) {
+            // Waking every waiter of the bucket, as it is shared
+            bucket &slot = bucket_of(&word);
+            { std::lock_guard<std::mutex> lock(slot.mutex); }
+            slot.condition.notify_all();
+        }
+
+#endif
+
+    } // namespace detail
+
+} // namespace tdl
@@ -0,0 +1,44 @@
+#pragma once
+#ifndef FUTEX_H
+#define FUTEX_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+namespace tdl {
+
+    namespace detail {
+
+        /**
+         * @brief   Blocks the calling thread while the supplied
+         *          word holds the expected value, until woken up
+         *          by futex_wake() or until the timeout expires.
+         * @details On Linux this is a private futex wait, on other
+         *          platforms a striped table of mutexes and condition
+         *          variables is used. Spurious wakeups are possible,
+         *          callers must re-check their condition.
+         * @param   The word to wait on.
+         * @param   The value the word is expected to hold.
+         * @param   Maximum time to block (microseconds::max() blocks
+         *          without a timeout).
+         */
+        void futex_wait(std::atomic<std::uint32_t> &word,
+                        std::uint32_t expected,
+                        std::chrono::microseconds timeout = std::chrono::microseconds::max());
+
+        /**
+         * @brief Wakes up at most the given number of threads
+         *        blocked in futex_wait() on the supplied word.
+         *        The word must be modified before calling it.
+         * @param The word the threads are waiting on.
+         * @param Maximum number of threads to wake up.
+         */
+        void futex_wake(std::atomic<std::uint32_t> &word, std::size_t count);
+
+    } // namespace detail
+
+} // namespace tdl
+
+#endif // FUTEX_H
@@ -0,0 +1,47 @@
+#include "future.h"
+#include "tdl.h"
+
+namespace tdl {
+
+    namespace detail {
+
+        FutureBase::FutureBase()
+            : m_ready(false),
+              m_then(nullptr)
+        {}
+
+        FutureBase::~FutureBase() {
+            // Releasing a continuation that was never pushed
+            Task *then = m_then.load(std::memory_order_relaxed);
+            if (then != nullptr && then != this)
+                task_ptr::adopt(then);
+        }
+
+        bool FutureBase::is_ready() const {
+            return m_ready.load(std::memory_order_acquire);
+        }
+
+        void FutureBase::attach(const task_ptr &continuation) {
+            // Registering the continuation while not ready
+            Task *expected = nullptr;
+            Task *registered = task_ptr(continuation).detach();
+            if (m_then.compare_exchange_strong(expected, registered,
+                                               std::memory_order_acq_rel))
+                return;
+
+            // Pushing it directly if the value is already stored
+            detail::push_task(task_ptr::adopt(registered));
+        }
+
+        void FutureBase::make_ready() {
+            m_ready.store(true, std::memory_order_release);
+
+            // Closing the slot, using this as the closed marker
+            Task *then = m_then.exchange(this, std::memory_order_acq_rel);
+            if (then != nullptr)
+                detail::push_task(task_ptr::adopt(then));
+        }
+
+    } // namespace detail
+
+} // namespace tdl
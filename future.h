@@ -0,0 +1,373 @@
+#pragma once
+#ifndef FUTURE_H
+#define FUTURE_H
+
+#include <new>
+#include <atomic>
+#include <utility>
+#include <type_traits>
+
+#include "task.h"
+#include "pool.h"
+#include "types.h"
+#include "callables.h"
+
+namespace tdl {
+
+    template <class T> class future;
+    template <class T> class promise;
+
+    /** Declared in tdl.h, used by the future producing overloads. */
+    void submit(const task_ptr &task);
+    void spawn(const task_ptr &task);
+
+    namespace detail {
+
+        /**
+         * @brief The FutureBase class is the type independent part
+         *        of the state shared by a tdl::future and the Task
+         *        producing it's value. It tracks readiness and holds
+         *        the (single) continuation registered by then().
+         */
+        class FutureBase : public Task {
+        public:
+            /** Releases a continuation that was never scheduled. */
+            ~FutureBase();
+
+            /**
+             * @brief Returns true if the value has been stored.
+             */
+            bool is_ready() const;
+
+            /**
+             * @brief Schedules the supplied Task when the value is
+             *        stored: it is pushed to the worker that stores
+             *        the value, or immediately to the calling worker
+             *        if the value is already available.
+             * @param The continuation Task.
+             */
+            void attach(const task_ptr &continuation);
+
+        protected:
+            /** Constructs a FutureBase without a value. */
+            FutureBase();
+
+            /**
+             * @brief Marks the value as stored, and pushes the
+             *        registered continuation (if any).
+             */
+            void make_ready();
+
+        private:
+            std::atomic<bool>   m_ready;
+            std::atomic<Task*>  m_then;
+        };
+
+        /**
+         * @brief The FutureState class stores the value of type T
+         *        inside the Task object, without further allocation.
+         */
+        template <class T>
+        class FutureState : public FutureBase {
+        public:
+            ~FutureState() {
+                if (is_ready()) value().~T();
+            }
+
+            /** Constructs the value in place and marks it ready. */
+            template <class... Args>
+            void emplace(Args&&... args) {
+                new (&m_storage) T(std::forward<Args>(args)...);
+                make_ready();
+            }
+
+            /** Stores the result of the supplied Callable. */
+            template <class Function>
+            void emplace_result(Function &function) {
+                emplace(function());
+            }
+
+            /** Returns the stored value. */
+            T &value() {
+                return *reinterpret_cast<T*>(&m_storage);
+            }
+
+            /** Moves the stored value out. */
+            T take() {
+                return std::move(value());
+            }
+
+        private:
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type m_storage;
+        };
+
+        /**
+         * @brief Specialization of FutureState for futures
+         *        signalling completion without a value.
+         */
+        template <>
+        class FutureState<void> : public FutureBase {
+        public:
+            void emplace() {
+                make_ready();
+            }
+
+            template <class Function>
+            void emplace_result(Function &function) {
+                function();
+                make_ready();
+            }
+
+            void value() {}
+            void take() {}
+        };
+
+        /**
+         * @brief The FutureTask class is a Task executing a
+         *        Callable and storing it's result for a future.
+         */
+        template <class T, class Function>
+        class FutureTask final : public FutureState<T> {
+        public:
+            explicit FutureTask(Function &&function)
+                : m_function(std::move(function))
+            {
+                static_assert(pool_aligned<FutureTask>(),
+                              "Future returning submit(), spawn() and then() require C++17 aligned "
+                              "new for over-aligned callables and results.");
+            }
+
+        private:
+            Function m_function;
+
+            virtual void execute() override {
+                this->emplace_result(m_function);
+            }
+        };
+
+        /**
+         * @brief The PromiseState class is the shared state of a
+         *        tdl::promise. It is never scheduled, the Task is
+         *        processed when the promise is fulfilled.
+         */
+        template <class T>
+        class PromiseState final : public FutureState<T> {
+        public:
+            PromiseState() {
+                static_assert(pool_aligned<PromiseState>(),
+                              "tdl::promise requires C++17 aligned new for "
+                              "over-aligned results.");
+            }
+
+        private:
+            virtual void execute() override {}
+        };
+
+        /** Invokes a then() continuation with the previous value. */
+        template <class Function, class T>
+        auto invoke_with_value(Function &function, FutureState<T> &state)
+            -> decltype(function(state.take()))
+        {
+            return function(state.take());
+        }
+
+        template <class Function>
+        auto invoke_with_value(Function &function, FutureState<void> &)
+            -> decltype(function())
+        {
+            return function();
+        }
+
+        /** Result type of a Callable bound to the supplied arguments. */
+        template <class Function, class... Args>
+        using bound_result_t = decltype(bind_arguments(std::declval<Function>(), std::declval<Args>()...)());
+
+        /** Enables the future overloads for Callables only. */
+        template <class Function, class Result>
+        using enable_for_callable_t = typename std::enable_if<
+            !std::is_convertible<Function, task_ptr>::value, Result>::type;
+
+        /** Creates the FutureTask for the supplied Callable and arguments. */
+        template <class Function, class... Args>
+        intrusive_ptr<FutureState<bound_result_t<Function, Args...>>>
+        make_future_task(Function &&function, Args&&... args) {
+            using result_t = bound_result_t<Function, Args...>;
+            auto bound = bind_arguments(std::forward<Function>(function), std::forward<Args>(args)...);
+            return intrusive_ptr<FutureState<result_t>>(
+                new FutureTask<result_t, decltype(bound)>(std::move(bound)));
+        }
+
+    } // namespace detail
+
+    /**
+     * @brief   The future class provides access to the result of
+     *          a Task submitted or spawned with a Callable. The
+     *          result is stored inside the Task object itself.
+     * @details A future is obtained from the future producing
+     *          overloads of tdl::submit() and tdl::spawn(), from
+     *          tdl::promise::get_future(), or from then().
+     */
+    template <class T>
+    class future final {
+    public:
+        /** Constructs an invalid future. */
+        future() = default;
+
+        /**
+         * @brief Returns true if the future refers to a state.
+         */
+        bool valid() const {
+            return m_state != nullptr;
+        }
+
+        /**
+         * @brief Returns true if the result is available.
+         *        Does not block.
+         */
+        bool is_ready() const {
+            return m_state->is_ready();
+        }
+
+        /**
+         * @brief Blocks until the producing Task is finished.
+         */
+        void wait() const {
+            m_state->wait();
+        }
+
+        /**
+         * @brief Waits for the result and moves it out of the
+         *        future. The future becomes invalid.
+         */
+        T get() {
+            wait();
+            auto state = std::move(m_state);
+            return state->take();
+        }
+
+        /**
+         * @brief   Registers a Callable to be executed with the
+         *          result once it is available. The continuation is
+         *          pushed to the worker that produces the result (or
+         *          to the calling worker if it is already available).
+         *          The future becomes invalid.
+         * @param   Callable invoked with the result (moved out of
+         *          this future), or without arguments for future<void>.
+         * @return  A future for the result of the Callable.
+         */
+        template <class Function>
+        auto then(Function &&function)
+            -> future<decltype(detail::invoke_with_value(std::declval<typename std::decay<Function>::type&>(),
+                                                         std::declval<detail::FutureState<T>&>()))>
+        {
+            using callable_t = typename std::decay<Function>::type;
+            using result_t = decltype(detail::invoke_with_value(std::declval<callable_t&>(),
+                                                                std::declval<detail::FutureState<T>&>()));
+
+            auto state = std::move(m_state);
+            auto continuation = [state, function = callable_t(std::forward<Function>(function))]() mutable {
+                return detail::invoke_with_value(function, *state);
+            };
+
+            intrusive_ptr<detail::FutureState<result_t>> next(
+                new detail::FutureTask<result_t, decltype(continuation)>(std::move(continuation)));
+            state->attach(next);
+
+            return future<result_t>(std::move(next));
+        }
+
+    private:
+        template <class> friend class future;
+        template <class> friend class promise;
+
+        template <class Function, class... Args>
+        friend auto submit(Function&&, Args&&...)
+            -> detail::enable_for_callable_t<Function, future<detail::bound_result_t<Function, Args...>>>;
+
+        template <class Function, class... Args>
+        friend auto spawn(Function&&, Args&&...)
+            -> detail::enable_for_callable_t<Function, future<detail::bound_result_t<Function, Args...>>>;
+
+        explicit future(intrusive_ptr<detail::FutureState<T>> state)
+            : m_state(std::move(state))
+        {}
+
+        intrusive_ptr<detail::FutureState<T>> m_state;
+    };
+
+    /**
+     * @brief The promise class lets any thread provide the value
+     *        of a tdl::future explicitly.
+     */
+    template <class T>
+    class promise final {
+    public:
+        /** Constructs a promise with a new shared state. */
+        promise()
+            : m_state(new detail::PromiseState<T>())
+        {}
+
+        /**
+         * @brief Returns the future associated with the promise.
+         */
+        future<T> get_future() const {
+            return future<T>(m_state);
+        }
+
+        /**
+         * @brief   Stores the value (constructed from the supplied
+         *          arguments) and completes the shared state. Must
+         *          only be called once. Continuations are pushed to
+         *          the calling worker, or submitted if called from
+         *          a thread that is not a worker.
+         * @param   Arguments to construct the value from (none for
+         *          promise<void>).
+         */
+        template <class... Args>
+        void set_value(Args&&... args) {
+            m_state->emplace(std::forward<Args>(args)...);
+            m_state->process();
+        }
+
+    private:
+        intrusive_ptr<detail::FutureState<T>> m_state;
+    };
+
+    /**
+     * @brief   Submits a Task executing the supplied Callable with
+     *          the bound arguments, and returns a future for it's
+     *          result. See tdl::submit() for details.
+     * @param   Callable to be executed when processing the Task.
+     * @param   Arguments to be bound for Task execution.
+     * @return  A tdl::future for the result of the Callable.
+     */
+    template <class Function, class... Args>
+    auto submit(Function &&function, Args&&... args)
+        -> detail::enable_for_callable_t<Function, future<detail::bound_result_t<Function, Args...>>>
+    {
+        auto state = detail::make_future_task(std::forward<Function>(function), std::forward<Args>(args)...);
+        submit(task_ptr(state));
+        return future<detail::bound_result_t<Function, Args...>>(std::move(state));
+    }
+
+    /**
+     * @brief   Spawns a Task executing the supplied Callable with
+     *          the bound arguments as a child of the caller, and
+     *          returns a future for it's result. See tdl::spawn()
+     *          for details.
+     * @param   Callable to be executed when processing the Task.
+     * @param   Arguments to be bound for Task execution.
+     * @return  A tdl::future for the result of the Callable.
+     */
+    template <class Function, class... Args>
+    auto spawn(Function &&function, Args&&... args)
+        -> detail::enable_for_callable_t<Function, future<detail::bound_result_t<Function, Args...>>>
+    {
+        auto state = detail::make_future_task(std::forward<Function>(function), std::forward<Args>(args)...);
+        spawn(task_ptr(state));
+        return future<detail::bound_result_t<Function, Args...>>(std::move(state));
+    }
+
+} // namespace tdl
+
+#endif // FUTURE_H
@@ -0,0 +1,99 @@
+#include "graph.h"
+#include "dependencies.h"
+#include "tdl.h"
+#include "exceptions.h"
+
+namespace tdl {
+
+    graph::graph()
+        : m_sink_predecessors(0),
+          m_dirty(true)
+    {}
+
+    task_ptr graph::add(const task_ptr &task) {
+        // Keeping the successor links of the node between executions
+        task->m_retain_successors = true;
+        m_indices.emplace(task.get(), m_nodes.size());
+        m_nodes.push_back(node {task, 0});
+        m_has_successors.push_back(false);
+        m_dirty = true;
+        return task;
+    }
+
+    void graph::precede(const task_ptr &predecessor, const task_ptr &successor) {
+        std::size_t from = index_of(predecessor);
+        std::size_t to   = index_of(successor);
+        m_nodes[to].predecessors++;
+        m_has_successors[from] = true;
+
+        // Linking into the list closed by the last execution
+        predecessor->reopen_successors();
+        predecessor->precede(successor);
+        m_dirty = true;
+    }
+
+    void graph::launch() {
+        // Collecting roots and creating the sink after modifications
+        if (m_dirty) finalize();
+
+        // Resetting the counters of every node
+        for (node &current : m_nodes)
+            current.task->reset(current.predecessors);
+        m_sink->reset(m_sink_predecessors);
+
+        // Submitting the nodes without predecessors
+        for (const task_ptr &root : m_roots)
+            tdl::submit(root);
+    }
+
+    bool graph::finished() const {
+        return m_sink == nullptr || m_sink->get_refcount() == 0;
+    }
+
+    void graph::wait() {
+        if (m_sink != nullptr) m_sink->wait();
+    }
+
+    std::size_t graph::size() const {
+        return m_nodes.size();
+    }
+
+    std::size_t graph::index_of(const task_ptr &task) const {
+        auto it = m_indices.find(task.get());
+        if (it == m_indices.end())
+            throw graph_exception();
+        return it->second;
+    }
+
+    void graph::finalize() {
+        // Collecting the nodes without predecessors
+        m_roots.clear();
+        for (const node &current : m_nodes) {
+            if (current.predecessors == 0) m_roots.push_back(current.task);
+        }
+
+        // Removing the links to the sink of the previous finalization
+        if (m_sink == nullptr) {
+            m_sink = task_ptr(new detail::JoinTask(join_mode::all));
+            m_sink->m_retain_successors = true;
+        }
+        for (const node &current : m_nodes)
+            current.task->remove_successor(m_sink.get());
+
+        // Joining the nodes without successors into the sink
+        m_sink_predecessors = 0;
+        for (std::size_t i = 0; i < m_nodes.size(); i++) {
+            if (!m_has_successors[i]) {
+                m_nodes[i].task->reopen_successors();
+                m_nodes[i].task->precede(m_sink);
+                m_sink_predecessors++;
+            }
+        }
+
+        // Submitting the sink directly if the graph is empty
+        if (m_sink_predecessors == 0) m_roots.push_back(m_sink);
+
+        m_dirty = false;
+    }
+
+} // namespace tdl
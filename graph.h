@@ -0,0 +1,121 @@
+#pragma once
+#ifndef GRAPH_H
+#define GRAPH_H
+
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <cstdint>
+
+#include "task.h"
+#include "types.h"
+#include "make.h"
+
+namespace tdl {
+
+    /**
+     * @brief   The graph class records a topology of Tasks once,
+     *          and executes it any number of times.
+     * @details Nodes and edges are allocated when the graph is
+     *          built. launch() only resets the counters of the nodes
+     *          and submits the nodes without predecessors, the rest
+     *          is pushed by the workers finishing their predecessors.
+     *          A graph must not be modified or launched again while
+     *          it is executing, call wait() first. Nodes must not be
+     *          submitted or spawned individually.
+     */
+    class graph final {
+    public:
+        /** Constructs an empty graph. */
+        graph();
+
+        /** Copying a graph is forbidden. */
+        graph(const graph&) = delete;
+        graph& operator=(const graph&) = delete;
+
+        /**
+         * @brief  Adds a Task as a node of the graph.
+         * @param  The Task (created by tdl::make(), tdl::discards(), etc).
+         * @return The Task, used as the node handle.
+         */
+        task_ptr add(const task_ptr &task);
+
+        /**
+         * @brief  Adds a node executing the supplied Callable with
+         *         the bound arguments. See tdl::discards().
+         * @return The created Task, used as the node handle.
+         */
+        template <class Function, class... Args>
+        task_ptr emplace(Function &&function, Args&&... args) {
+            return add(discards(std::forward<Function>(function), std::forward<Args>(args)...));
+        }
+
+        /**
+         * @brief Adds an edge: the successor node is executed
+         *        after the predecessor node has finished. Edges
+         *        may be added between executions. Throws
+         *        tdl::graph_exception if either Task is not a
+         *        node of the graph.
+         * @param The predecessor node.
+         * @param The successor node.
+         */
+        void precede(const task_ptr &predecessor, const task_ptr &successor);
+
+        /**
+         * @brief Starts an execution of the graph.
+         */
+        void launch();
+
+        /**
+         * @brief Returns true if the last execution has finished
+         *        (or the graph was never launched).
+         */
+        bool finished() const;
+
+        /**
+         * @brief Blocks until the last execution has finished.
+         *        See tdl::Task::wait().
+         */
+        void wait();
+
+        /**
+         * @brief Returns the number of nodes.
+         */
+        std::size_t size() const;
+
+    private:
+        /**
+         * @brief The node struct stores a Task of the graph
+         *        together with its number of predecessors.
+         */
+        struct node {
+            task_ptr        task;
+            std::uint32_t   predecessors;
+        };
+
+        /**
+         * @brief Returns the index of the node storing the Task.
+         *        Throws tdl::graph_exception if there is none.
+         */
+        std::size_t index_of(const task_ptr &task) const;
+
+        /**
+         * @brief Links the nodes without successors to the Task
+         *        joining them (created on first use), used to detect
+         *        the end of an execution. The links of the previous
+         *        finalization are removed first.
+         */
+        void finalize();
+
+        std::vector<node>                               m_nodes;
+        std::unordered_map<const Task*, std::size_t>    m_indices;
+        std::vector<task_ptr>                           m_roots;
+        std::vector<bool>                               m_has_successors;
+        task_ptr                                        m_sink;
+        std::uint32_t                                   m_sink_predecessors;
+        bool                                            m_dirty;
+    };
+
+} // namespace tdl
+
+#endif // GRAPH_H
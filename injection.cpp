@@ -0,0 +1,76 @@
+#include "injection.h"
+
+namespace tdl {
+
+    InjectionQueue::InjectionQueue()
+        : m_head(nullptr),
+          m_size(0),
+          m_taking(false),
+          m_drained(nullptr)
+    {}
+
+    void InjectionQueue::push(Task *task) {
+        push(task, task, 1);
+    }
+
+    void InjectionQueue::push(Task *first, Task *last, std::size_t count) {
+        // Counting before publishing, so size() never underestimates
+        m_size.fetch_add(count, std::memory_order_relaxed);
+
+        Task *head = m_head.load(std::memory_order_relaxed);
+        do {
+            last->m_next_injected = head;
+        } while (!m_head.compare_exchange_weak(head, first,
+                                               std::memory_order_release,
+                                               std::memory_order_relaxed));
+    }
+
+    Task* InjectionQueue::take(std::size_t count) {
+        // Checking before claiming, to keep empty queues unmodified
+        if (m_size.load(std::memory_order_relaxed) == 0) return nullptr;
+
+        // Claiming the drained list, without waiting for other consumers
+        if (m_taking.load(std::memory_order_relaxed) ||
+            m_taking.exchange(true, std::memory_order_acquire))
+            return nullptr;
+
+        // Reversing the pushed Tasks into the drained list, oldest first
+        if (m_drained == nullptr) {
+            Task *task = m_head.exchange(nullptr, std::memory_order_acquire);
+            while (task != nullptr) {
+                Task *next = task->m_next_injected;
+                task->m_next_injected = m_drained;
+                m_drained = task;
+                task = next;
+            }
+        }
+
+        // Unlinking the oldest Tasks, newest taken first in the result
+        Task *taken = nullptr;
+        std::size_t taken_count = 0;
+        while (m_drained != nullptr && taken_count < count) {
+            Task *task = m_drained;
+            m_drained = task->m_next_injected;
+            task->m_next_injected = taken;
+            taken = task;
+            taken_count++;
+        }
+        m_size.fetch_sub(taken_count, std::memory_order_relaxed);
+
+        m_taking.store(false, std::memory_order_release);
+        return taken;
+    }
+
+    std::size_t InjectionQueue::size() const {
+        return m_size.load(std::memory_order_relaxed);
+    }
+
+    Task* InjectionQueue::next(Task *task) {
+        return task->m_next_injected;
+    }
+
+    void InjectionQueue::link(Task *task, Task *next) {
+        task->m_next_injected = next;
+    }
+
+} // namespace tdl
@@ -0,0 +1,89 @@
+#pragma once
+#ifndef INJECTION_H
+#define INJECTION_H
+
+#include <atomic>
+#include <cstddef>
+
+#include "task.h"
+
+namespace tdl {
+
+    /**
+     * @brief   The InjectionQueue class is a lock-free queue of
+     *          Tasks submitted to a worker from any thread.
+     * @details Producers push Tasks (or pre-linked batches) with
+     *          a single CAS on the head of an intrusive stack (the
+     *          Tasks are linked through Task::m_next_injected, so
+     *          pushing does not allocate). Consumers take the whole
+     *          stack with a single exchange, so it is free of the
+     *          ABA problem, and reverse it into a FIFO list of
+     *          drained Tasks, owned by one consumer at a time. Tasks
+     *          are taken from the oldest end of that list, and the
+     *          stack is only drained again once the list is empty,
+     *          so Tasks are taken in submission order, and each
+     *          Task is linked and unlinked a constant number of
+     *          times. Queued Tasks are raw pointers holding a
+     *          reference (see tdl::Worker).
+     */
+    class InjectionQueue final {
+    public:
+        /** Constructs an empty InjectionQueue. */
+        InjectionQueue();
+
+        /** Copying an InjectionQueue is forbidden. */
+        InjectionQueue(const InjectionQueue&) = delete;
+        InjectionQueue& operator=(const InjectionQueue&) = delete;
+
+        /**
+         * @brief Pushes a Task to the queue.
+         * @param The Task to push.
+         */
+        void push(Task *task);
+
+        /**
+         * @brief Pushes a batch of Tasks linked by link() to
+         *        the queue in a single operation.
+         * @param The first (newest) Task of the batch.
+         * @param The last (oldest) Task of the batch.
+         * @param The number of Tasks in the batch.
+         */
+        void push(Task *first, Task *last, std::size_t count);
+
+        /**
+         * @brief  Takes the oldest Tasks from the queue. Does not
+         *         wait for a concurrent consumer, but returns nullptr
+         *         as if the queue was empty.
+         * @param  The maximum number of Tasks to take (at least 1).
+         * @return The newest taken Task, linked to the older ones by
+         *         next(), or nullptr if no Task was taken.
+         */
+        Task* take(std::size_t count);
+
+        /**
+         * @brief Returns the (approximate) number of Tasks.
+         *        Never less than the number of queued Tasks.
+         */
+        std::size_t size() const;
+
+        /**
+         * @brief Returns the Task queued after the supplied one.
+         */
+        static Task* next(Task *task);
+
+        /**
+         * @brief Links the supplied Task to the next one, to
+         *        build a batch for push().
+         */
+        static void link(Task *task, Task *next);
+
+    private:
+        std::atomic<Task*>          m_head;
+        std::atomic<std::size_t>    m_size;
+        std::atomic<bool>           m_taking;
+        Task*                       m_drained;
+    };
+
+} // namespace tdl
+
+#endif // INJECTION_H
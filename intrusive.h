@@ -0,0 +1,173 @@
+#pragma once
+#ifndef INTRUSIVE_H
+#define INTRUSIVE_H
+
+#include <cstddef>
+#include <utility>
+#include <functional>
+#include <type_traits>
+
+namespace tdl {
+
+    /**
+     * @brief   The intrusive_ptr class is an RAII smart pointer for
+     *          objects carrying their own reference count.
+     * @details Unlike std::shared_ptr it requires no separate control
+     *          block, and it is the size of a raw pointer. The pointee
+     *          type must provide the functions intrusive_retain(T*) and
+     *          intrusive_release(T*) (found by argument-dependent lookup),
+     *          the latter destroying the object when the count drops
+     *          to zero.
+     */
+    template <class T>
+    class intrusive_ptr final {
+    public:
+        using element_type = T;
+
+        /** Constructs an empty intrusive_ptr. */
+        constexpr intrusive_ptr() noexcept
+            : m_ptr(nullptr)
+        {}
+
+        /** Constructs an empty intrusive_ptr. */
+        constexpr intrusive_ptr(std::nullptr_t) noexcept
+            : m_ptr(nullptr)
+        {}
+
+        /**
+         * @brief Constructs an intrusive_ptr sharing ownership
+         *        of the supplied object.
+         * @param Pointer to the object (or nullptr).
+         */
+        explicit intrusive_ptr(T *ptr) noexcept
+            : m_ptr(ptr)
+        {
+            if (m_ptr != nullptr) intrusive_retain(m_ptr);
+        }
+
+        /** Copy and move construction. */
+        intrusive_ptr(const intrusive_ptr &other) noexcept
+            : intrusive_ptr(other.m_ptr)
+        {}
+
+        intrusive_ptr(intrusive_ptr &&other) noexcept
+            : m_ptr(other.m_ptr)
+        {
+            other.m_ptr = nullptr;
+        }
+
+        /** Converting construction from derived types. */
+        template <class U, class = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+        intrusive_ptr(const intrusive_ptr<U> &other) noexcept
+            : intrusive_ptr(other.get())
+        {}
+
+        template <class U, class = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+        intrusive_ptr(intrusive_ptr<U> &&other) noexcept
+            : m_ptr(other.detach())
+        {}
+
+        /** Releases the owned object (if any). */
+        ~intrusive_ptr() {
+            if (m_ptr != nullptr) intrusive_release(m_ptr);
+        }
+
+        /** Copy and move assignment. */
+        intrusive_ptr& operator=(intrusive_ptr other) noexcept {
+            swap(other);
+            return *this;
+        }
+
+        /**
+         * @brief  Takes over a reference previously released by
+         *         detach(), without incrementing the count.
+         * @param  Pointer returned by detach().
+         */
+        static intrusive_ptr adopt(T *ptr) noexcept {
+            intrusive_ptr adopted;
+            adopted.m_ptr = ptr;
+            return adopted;
+        }
+
+        /**
+         * @brief  Gives up ownership without decrementing the count.
+         *         The reference must later be passed to adopt().
+         * @return The raw pointer to the formerly owned object.
+         */
+        T *detach() noexcept {
+            T *ptr = m_ptr;
+            m_ptr = nullptr;
+            return ptr;
+        }
+
+        /** Releases the owned object, leaving the pointer empty. */
+        void reset() noexcept {
+            intrusive_ptr().swap(*this);
+        }
+
+        /** Exchanges the owned objects. */
+        void swap(intrusive_ptr &other) noexcept {
+            std::swap(m_ptr, other.m_ptr);
+        }
+
+        /** Accessors. */
+        T *get() const noexcept         { return m_ptr; }
+        T &operator*() const noexcept   { return *m_ptr; }
+        T *operator->() const noexcept  { return m_ptr; }
+        explicit operator bool() const noexcept { return m_ptr != nullptr; }
+
+    private:
+        T *m_ptr;
+    };
+
+    /** Comparison operators. */
+    template <class T, class U>
+    bool operator==(const intrusive_ptr<T> &lhs, const intrusive_ptr<U> &rhs) noexcept {
+        return lhs.get() == rhs.get();
+    }
+
+    template <class T, class U>
+    bool operator!=(const intrusive_ptr<T> &lhs, const intrusive_ptr<U> &rhs) noexcept {
+        return lhs.get() != rhs.get();
+    }
+
+    template <class T>
+    bool operator==(const intrusive_ptr<T> &lhs, std::nullptr_t) noexcept {
+        return lhs.get() == nullptr;
+    }
+
+    template <class T>
+    bool operator==(std::nullptr_t, const intrusive_ptr<T> &rhs) noexcept {
+        return rhs.get() == nullptr;
+    }
+
+    template <class T>
+    bool operator!=(const intrusive_ptr<T> &lhs, std::nullptr_t) noexcept {
+        return lhs.get() != nullptr;
+    }
+
+    template <class T>
+    bool operator!=(std::nullptr_t, const intrusive_ptr<T> &rhs) noexcept {
+        return rhs.get() != nullptr;
+    }
+
+    template <class T>
+    bool operator<(const intrusive_ptr<T> &lhs, const intrusive_ptr<T> &rhs) noexcept {
+        return std::less<T*>()(lhs.get(), rhs.get());
+    }
+
+} // namespace tdl
+
+namespace std {
+
+    /** Hashing support for unordered containers. */
+    template <class T>
+    struct hash<tdl::intrusive_ptr<T>> {
+        std::size_t operator()(const tdl::intrusive_ptr<T> &ptr) const noexcept {
+            return std::hash<T*>()(ptr.get());
+        }
+    };
+
+} // namespace std
+
+#endif // INTRUSIVE_H
@@ -0,0 +1,166 @@
+#include "latency.h"
+
+#include <cmath>
+#include <algorithm>
+
+namespace tdl {
+
+    constexpr std::size_t histogram::sub_bucket_bits;
+    constexpr std::size_t histogram::bucket_count;
+
+    namespace {
+
+        constexpr std::size_t sub_bucket_count = std::size_t(1) << histogram::sub_bucket_bits;
+
+        /** Returns the index of the most significant set bit (value > 0). */
+        std::size_t most_significant_bit(std::uint64_t value) {
+            std::size_t bit = 0;
+            for (std::size_t shift = 32; shift > 0; shift /= 2) {
+                if (value >> shift) {
+                    value >>= shift;
+                    bit += shift;
+                }
+            }
+            return bit;
+        }
+
+    } // namespace
+
+    histogram::histogram()
+        : m_buckets(bucket_count, 0),
+          m_count(0),
+          m_max(0)
+    {}
+
+    void histogram::record(std::chrono::nanoseconds value, std::uint64_t count) {
+        std::uint64_t ns = value.count() < 0 ? 0 : static_cast<std::uint64_t>(value.count());
+        m_buckets[bucket_index(ns)] += count;
+        m_count += count;
+        if (count > 0) m_max = std::max(m_max, ns);
+    }
+
+    void histogram::merge(const histogram &other) {
+        for (std::size_t i = 0; i < bucket_count; i++)
+            m_buckets[i] += other.m_buckets[i];
+        m_count += other.m_count;
+        m_max = std::max(m_max, other.m_max);
+    }
+
+    std::uint64_t histogram::count() const {
+        return m_count;
+    }
+
+    std::chrono::nanoseconds histogram::max() const {
+        return std::chrono::nanoseconds(m_max);
+    }
+
+    std::chrono::nanoseconds histogram::percentile(double percent) const {
+        if (m_count == 0) return std::chrono::nanoseconds::zero();
+
+        // Finding the bucket holding the rank of the percentile
+        double fraction = std::min(std::max(percent, 0.0), 100.0) / 100.0;
+        std::uint64_t rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(
+            std::ceil(fraction * static_cast<double>(m_count))));
+
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < bucket_count; i++) {
+            seen += m_buckets[i];
+            if (seen >= rank)
+                return std::chrono::nanoseconds(std::min(bucket_limit(i), m_max));
+        }
+        return std::chrono::nanoseconds(m_max);
+    }
+
+    std::uint64_t histogram::bucket(std::size_t index) const {
+        return m_buckets[index];
+    }
+
+    std::size_t histogram::bucket_index(std::uint64_t value) {
+        // Small values have a bucket each
+        if (value < sub_bucket_count) return static_cast<std::size_t>(value);
+
+        // Others by their power of two, and the bits below the leading one
+        std::size_t shift = most_significant_bit(value) - sub_bucket_bits;
+        return ((shift + 1) << sub_bucket_bits) + static_cast<std::size_t>((value >> shift) - sub_bucket_count);
+    }
+
+    std::uint64_t histogram::bucket_limit(std::size_t index) {
+        if (index < sub_bucket_count) return index;
+
+        std::size_t shift = (index >> sub_bucket_bits) - 1;
+        std::uint64_t mantissa = sub_bucket_count + (index & (sub_bucket_count - 1));
+        return ((mantissa + 1) << shift) - 1;
+    }
+
+    void set_latency_tracking(bool enabled) {
+        detail::s_latency_tracking.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool get_latency_tracking() {
+        return detail::tracking_latency();
+    }
+
+    namespace detail {
+
+        std::atomic<bool> s_latency_tracking {false};
+
+        std::int64_t latency_clock() {
+            using namespace std::chrono;
+            return std::max<std::int64_t>(1, duration_cast<nanoseconds>(
+                steady_clock::now().time_since_epoch()).count());
+        }
+
+        LatencyRecorder::LatencyRecorder() {
+            for (std::atomic<Entry*> &entry : m_entries)
+                entry.store(nullptr, std::memory_order_relaxed);
+        }
+
+        LatencyRecorder::~LatencyRecorder() {
+            for (std::atomic<Entry*> &entry : m_entries)
+                delete entry.load(std::memory_order_relaxed);
+        }
+
+        void LatencyRecorder::record(std::uint32_t tag, std::int64_t queued,
+                                     std::int64_t started, std::int64_t finished) {
+            std::atomic<Entry*> &slot = m_entries[std::min<std::size_t>(tag, max_task_tags - 1)];
+
+            // Publishing the histograms of the tag on first use
+            Entry *entry = slot.load(std::memory_order_relaxed);
+            if (entry == nullptr) {
+                entry = new Entry();
+                slot.store(entry, std::memory_order_release);
+            }
+
+            if (queued != 0 && started >= queued)
+                entry->queue_delay.record(static_cast<std::uint64_t>(started - queued));
+            entry->execution.record(static_cast<std::uint64_t>(std::max<std::int64_t>(0, finished - started)));
+        }
+
+        void LatencyRecorder::collect(std::map<std::uint32_t, latency_stats> &stats) const {
+            for (std::size_t tag = 0; tag < max_task_tags; tag++) {
+                const Entry *entry = m_entries[tag].load(std::memory_order_acquire);
+                if (entry == nullptr) continue;
+
+                latency_stats &target = stats[static_cast<std::uint32_t>(tag)];
+                entry->queue_delay.collect(target.queue_delay);
+                entry->execution.collect(target.execution);
+            }
+        }
+
+        void LatencyRecorder::Counts::record(std::uint64_t value) {
+            std::atomic<std::uint64_t> &counter = buckets[histogram::bucket_index(value)];
+            counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        void LatencyRecorder::Counts::collect(histogram &target) const {
+            // Counting each bucket at it's upper limit
+            for (std::size_t i = 0; i < histogram::bucket_count; i++) {
+                std::uint64_t count = buckets[i].load(std::memory_order_relaxed);
+                if (count > 0)
+                    target.record(std::chrono::nanoseconds(histogram::bucket_limit(i)), count);
+            }
+        }
+
+    } // namespace detail
+
+} // namespace tdl
@@ -0,0 +1,205 @@
+#pragma once
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <map>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace tdl {
+
+    /**
+     * @brief The number of distinct Task tags latencies are recorded
+     *        for (see tdl::Task::set_tag()). Larger tags are recorded
+     *        under the last one.
+     */
+    constexpr std::size_t max_task_tags = 64;
+
+    /**
+     * @brief   The histogram class counts durations in log-linear
+     *          buckets, in the manner of an HDR histogram: each power
+     *          of two is split into 16 linear buckets, so a reported
+     *          value is at most 1/16 (6.25%) above the recorded one,
+     *          from nanoseconds to the full 64-bit range.
+     * @details Histograms of the same kind can be merged, for example
+     *          the ones of all workers, before reading percentiles.
+     */
+    class histogram final {
+    public:
+        /** Bits of a value selecting the bucket within it's power of two. */
+        static constexpr std::size_t sub_bucket_bits = 4;
+
+        /** The number of buckets covering all 64-bit values. */
+        static constexpr std::size_t bucket_count = (64 - sub_bucket_bits + 1) << sub_bucket_bits;
+
+        /** Constructs an empty histogram. */
+        histogram();
+
+        /**
+         * @brief Counts a duration.
+         * @param The duration (negative values count as zero).
+         * @param The number of times it was observed. (default: 1)
+         */
+        void record(std::chrono::nanoseconds value, std::uint64_t count = 1);
+
+        /**
+         * @brief Adds the counts of another histogram.
+         */
+        void merge(const histogram &other);
+
+        /**
+         * @brief Returns the number of recorded durations.
+         */
+        std::uint64_t count() const;
+
+        /**
+         * @brief Returns the largest recorded duration.
+         */
+        std::chrono::nanoseconds max() const;
+
+        /**
+         * @brief   Returns the duration below or at which the given
+         *          percentage of the recorded durations fall, e.g.
+         *          percentile(99.9) for the p999.
+         * @details The upper limit of the bucket is returned, so the
+         *          result errs on the high side. Returns zero if the
+         *          histogram is empty.
+         * @param   The percentage, in [0; 100].
+         */
+        std::chrono::nanoseconds percentile(double percent) const;
+
+        /**
+         * @brief Returns the number of durations counted in a bucket.
+         */
+        std::uint64_t bucket(std::size_t index) const;
+
+        /**
+         * @brief Returns the index of the bucket counting a value.
+         */
+        static std::size_t bucket_index(std::uint64_t value);
+
+        /**
+         * @brief Returns the largest value counted in a bucket.
+         */
+        static std::uint64_t bucket_limit(std::size_t index);
+
+    private:
+        std::vector<std::uint64_t>  m_buckets;
+        std::uint64_t               m_count;
+        std::uint64_t               m_max;
+    };
+
+    /**
+     * @brief The latency_stats struct holds the latencies recorded
+     *        for a Task tag: the queueing delay, from the moment a
+     *        Task was pushed to a queue until it's execution began,
+     *        and the execution time.
+     */
+    struct latency_stats {
+        histogram   queue_delay;
+        histogram   execution;
+    };
+
+    /**
+     * @brief   Starts or stops recording the latencies of Tasks.
+     * @details Tasks are timestamped when submitted, spawned, or
+     *          pushed as continuations and successors, and each
+     *          worker records the queueing delay and execution time
+     *          of the Tasks it executes into histograms of it's own,
+     *          under the tag of the Task. Enabling costs three clock
+     *          reads per Task. Has no effect if the library is built
+     *          with TDL_DISABLE_STATS.
+     * @param   True to record latencies. (default: false)
+     */
+    void set_latency_tracking(bool enabled);
+
+    /**
+     * @brief Returns true if the latencies of Tasks are recorded.
+     */
+    bool get_latency_tracking();
+
+    namespace detail {
+
+        /** True while recording latencies, see tdl::set_latency_tracking(). */
+        extern std::atomic<bool> s_latency_tracking;
+
+        /**
+         * @brief Returns true if latencies are recorded. When
+         *        disabled this costs a relaxed load and a branch.
+         */
+        inline bool tracking_latency() {
+#if defined(TDL_DISABLE_STATS)
+            return false;
+#else
+            return s_latency_tracking.load(std::memory_order_relaxed);
+#endif
+        }
+
+        /** Returns the current time in nanoseconds (never 0). */
+        std::int64_t latency_clock();
+
+        /**
+         * @brief   The LatencyRecorder class holds the latency
+         *          histograms of a Worker, per Task tag. They are
+         *          written by the worker's own thread only (relaxed
+         *          loads and stores), and read concurrently by
+         *          collect().
+         * @details The histograms of a tag are allocated when the
+         *          worker executes the first Task with that tag.
+         */
+        class LatencyRecorder final {
+        public:
+            LatencyRecorder();
+            ~LatencyRecorder();
+
+            /** Copying the recorder is forbidden. */
+            LatencyRecorder(const LatencyRecorder&) = delete;
+            LatencyRecorder& operator=(const LatencyRecorder&) = delete;
+
+            /**
+             * @brief Records the latencies of an executed Task.
+             * @param The tag of the Task.
+             * @param The time the Task was queued (0 if unknown,
+             *        then no queueing delay is recorded).
+             * @param The time it's execution began.
+             * @param The time it's execution ended.
+             */
+            void record(std::uint32_t tag, std::int64_t queued,
+                        std::int64_t started, std::int64_t finished);
+
+            /**
+             * @brief Merges the recorded histograms into the
+             *        statistics of each tag. May be called from
+             *        any thread.
+             */
+            void collect(std::map<std::uint32_t, latency_stats> &stats) const;
+
+        private:
+            /**
+             * @brief The Counts struct holds the bucket counts of a
+             *        histogram, as atomics read by collect().
+             */
+            struct Counts {
+                std::atomic<std::uint64_t>  buckets[histogram::bucket_count];
+
+                void record(std::uint64_t value);
+                void collect(histogram &target) const;
+            };
+
+            /** The histograms of a tag. */
+            struct Entry {
+                Counts  queue_delay;
+                Counts  execution;
+            };
+
+            std::atomic<Entry*>     m_entries[max_task_tags];
+        };
+
+    } // namespace detail
+
+} // namespace tdl
+
+#endif // LATENCY_H
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <fstream>
 #include <chrono>
 #include <random>
 #include <cmath>
@@ -8,33 +9,9 @@
 constexpr std::size_t data_size = 100000;
 constexpr std::size_t random_range = 100000000000;
 
-template <class iterator, class function>
-void parallel_for(iterator begin, iterator end, function f) {
-    // Calculating range division parameters
-    std::size_t range = (end - begin);
-    std::size_t partitions = tdl::get_worker_count();
-    std::size_t minimum_size = range / partitions;
-    std::size_t excess = range % partitions;
-
-    // Creating partitions
-    for (std::size_t i = 0; i < partitions; i++) {
-        // Calculating current partition size
-        std::size_t current_size = minimum_size;
-        if (excess) { current_size++; excess--; }
-
-        // Submitting current range calculation
-        tdl::spawn(tdl::discards([=](){
-            std::for_each(begin, begin + current_size, f);
-        }));
-
-        // Moving begin iterator to next range
-        begin += current_size;
-    }
-}
-
 using namespace std::chrono;
 
-int main() {
+int main(int argc, char *argv[]) {
 
     /*****************************************************************
      * Parallelism is much more effective when Tasks are relatively
@@ -95,9 +72,13 @@ int main() {
     // Initialization
     tdl::initialize();
 
+    // Recording a trace if a file name is passed
+    // (open it in chrome://tracing or ui.perfetto.dev)
+    if (argc > 1) tdl::set_tracing(true);
+
     // Parallel generation of random values
     auto random_filler = tdl::discards([&](){
-        parallel_for(std::begin(array_parallel), std::end(array_parallel), [&](double &value) {
+        tdl::parallel_for(std::begin(array_parallel), std::end(array_parallel), [&](double &value) {
             value = 1 + std::rand() % random_range;
             SIMULATE_LONG_EXECUTION;
         });
@@ -105,7 +86,7 @@ int main() {
 
     // Parallel calculation of the roots
     auto root_finder = tdl::discards([&](){
-        parallel_for(std::begin(array_parallel), std::end(array_parallel), [](double &value) {
+        tdl::parallel_for(std::begin(array_parallel), std::end(array_parallel), [](double &value) {
             value = std::sqrt(value);
             SIMULATE_LONG_EXECUTION;
         });
@@ -125,6 +106,13 @@ int main() {
 
     std::cout << "Parallel execution time: " << parallel_elapsed << " us." << std::endl;
 
+    // Writing the trace
+    if (argc > 1) {
+        tdl::set_tracing(false);
+        std::ofstream trace(argv[1]);
+        tdl::write_trace(trace);
+    }
+
     tdl::shutdown();
     return 0;
 }
@@ -6,6 +6,7 @@
 #include <type_traits>
 
 #include "task.h"
+#include "pool.h"
 #include "types.h"
 #include "callables.h"
 
@@ -19,25 +20,31 @@ namespace tdl {
      * @return  A tdl::task_ptr to the created Task.
      */
     template <class TaskType, class ...Args>
-    inline task_ptr make(Args... args) {
+    inline task_ptr make(Args&&... args) {
         // Static assertion for TaskType
         static_assert(std::is_base_of<Task,TaskType>::value,
                       "tdl::make_task() requires the template-argument "
                       "to be derived from tdl::Task.");
-        return std::make_shared<TaskType>(std::forward<Args>(args)...);
+        static_assert(detail::pool_aligned<TaskType>(),
+                      "tdl::make() requires C++17 aligned new for "
+                      "over-aligned Task types.");
+        return task_ptr(new TaskType(std::forward<Args>(args)...));
     }
 
     /**
      * @brief   Allocates and construct a Task from the provided
      *          Callable by binding the provided arguments to it.
      *          The result returned from the callable is discarded.
+     *          The Callable and the arguments are moved or copied
+     *          into the Task, move-only types are supported.
      * @param   Callable to be executed when processing the Task.
      * @param   Arguments to be bound for Task execution.
      * @return  A tdl::task_ptr to the created Task.
      */
     template <class Function, class... Args>
     task_ptr discards(Function &&function, Args&&... args) {
-        return std::make_shared<CallableWithoutReturn>(std::bind(function, std::forward<Args>(args)...));
+        return task_ptr(new CallableWithoutReturn(
+            detail::bind_arguments(std::forward<Function>(function), std::forward<Args>(args)...)));
     }
 
     /**
@@ -53,8 +60,9 @@ namespace tdl {
      */
     template <class Function, class Result, class... Args>
     task_ptr returns(Function&& function, Result &result, Args&&... args) {
-        return discards([=, &result](){
-           result = function(args...);
+        auto bound = detail::bind_arguments(std::forward<Function>(function), std::forward<Args>(args)...);
+        return discards([bound = std::move(bound), &result]() mutable {
+           result = bound();
         });
     }
 
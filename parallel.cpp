@@ -0,0 +1,46 @@
+#include "parallel.h"
+#include "tdl.h"
+
+namespace tdl {
+
+    auto_partitioner::auto_partitioner(std::size_t grain_size)
+        : m_grain_size(std::max<std::size_t>(grain_size, 1))
+    {}
+
+    std::size_t auto_partitioner::grain_size() const {
+        return m_grain_size;
+    }
+
+    static_partitioner::static_partitioner(std::size_t grain_size)
+        : m_grain_size(std::max<std::size_t>(grain_size, 1))
+    {}
+
+    std::size_t static_partitioner::grain_size() const {
+        return m_grain_size;
+    }
+
+    affinity_partitioner::affinity_partitioner(std::size_t grain_size)
+        : m_grain_size(std::max<std::size_t>(grain_size, 1))
+    {}
+
+    std::size_t affinity_partitioner::grain_size() const {
+        return m_grain_size;
+    }
+
+    std::vector<std::size_t>& affinity_partitioner::slots(std::size_t chunks) {
+        // Forgetting the recorded workers if the division changed
+        if (m_slots.size() != chunks)
+            m_slots.assign(chunks, detail::no_worker);
+        return m_slots;
+    }
+
+    namespace detail {
+
+        std::size_t chunk_count(std::size_t range, std::size_t grain_size) {
+            std::size_t chunks = std::min(current_worker_count(), range / grain_size);
+            return std::max<std::size_t>(chunks, 1);
+        }
+
+    } // namespace detail
+
+} // namespace tdl
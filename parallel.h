@@ -0,0 +1,349 @@
+#pragma once
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <iterator>
+#include <algorithm>
+#include <type_traits>
+
+#include "task.h"
+#include "types.h"
+#include "worker.h"
+#include "make.h"
+
+namespace tdl {
+
+    /** Declared in tdl.h, used by tdl::parallel_for(). */
+    void submit(const task_ptr &task);
+
+    namespace detail {
+        void spawn_child(const task_ptr &task, const task_ptr &parent);
+        void submit_to(std::size_t index, const task_ptr &task);
+        std::size_t current_worker_index();
+        std::size_t current_worker_count();
+    } // namespace detail
+
+    /**
+     * @brief   The auto_partitioner class makes tdl::parallel_for()
+     *          split the range on demand (lazy binary splitting).
+     * @details A range Task processes it's elements in chunks of
+     *          grain size. Before each chunk it checks the queues
+     *          of it's worker: if they are empty (the previously
+     *          split half has been stolen by an idle worker), it
+     *          splits off the upper half of the remaining range as
+     *          a new Task. Without idle workers the range is not
+     *          divided further, so large ranges only create as
+     *          many Tasks as there are steals.
+     */
+    class auto_partitioner final {
+    public:
+        /**
+         * @brief Constructs an auto_partitioner.
+         * @param The minimum number of elements processed between
+         *        two splitting attempts. Ranges are never split
+         *        below this size. (default: 1)
+         */
+        explicit auto_partitioner(std::size_t grain_size = 1);
+
+        /** Returns the grain size. */
+        std::size_t grain_size() const;
+
+    private:
+        std::size_t m_grain_size;
+    };
+
+    /**
+     * @brief The static_partitioner class makes tdl::parallel_for()
+     *        divide the range into one equal chunk per worker (but
+     *        not below grain size), and submit the chunks to the
+     *        workers in order. Chunks are not split further. Best
+     *        for uniform per-element cost.
+     */
+    class static_partitioner final {
+    public:
+        /**
+         * @brief Constructs a static_partitioner.
+         * @param The minimum number of elements in a chunk. (default: 1)
+         */
+        explicit static_partitioner(std::size_t grain_size = 1);
+
+        /** Returns the grain size. */
+        std::size_t grain_size() const;
+
+    private:
+        std::size_t m_grain_size;
+    };
+
+    /**
+     * @brief   The affinity_partitioner class makes tdl::parallel_for()
+     *          replay the distribution of a previous loop over a range
+     *          of the same size, to reuse the data left in the caches
+     *          of the workers.
+     * @details The range is divided into one chunk per worker, and
+     *          each chunk records the worker that executed it. When
+     *          the same partitioner is passed again, each chunk is
+     *          submitted to the recorded worker. Chunks are split on
+     *          demand like with tdl::auto_partitioner. The partitioner
+     *          must outlive the loops it is passed to, and must not be
+     *          used by two loops at the same time.
+     */
+    class affinity_partitioner final {
+    public:
+        /**
+         * @brief Constructs an affinity_partitioner.
+         * @param See tdl::auto_partitioner. (default: 1)
+         */
+        explicit affinity_partitioner(std::size_t grain_size = 1);
+
+        /** Returns the grain size. */
+        std::size_t grain_size() const;
+
+        /**
+         * @brief  Returns the recorded worker slots, resized to
+         *         the supplied chunk count. Used by parallel_for().
+         * @param  The number of chunks.
+         */
+        std::vector<std::size_t>& slots(std::size_t chunks);
+
+    private:
+        std::size_t                 m_grain_size;
+        std::vector<std::size_t>    m_slots;
+    };
+
+    namespace detail {
+
+        /**
+         * @brief Applies the loop body to each element of the
+         *        range. For integral ranges the body receives
+         *        the index, otherwise the dereferenced iterator.
+         */
+        template <class Iterator, class Body>
+        void apply_body(Iterator first, Iterator last, Body &body, std::true_type) {
+            for (; first != last; ++first) body(first);
+        }
+
+        template <class Iterator, class Body>
+        void apply_body(Iterator first, Iterator last, Body &body, std::false_type) {
+            for (; first != last; ++first) body(*first);
+        }
+
+        /**
+         * @brief The LoopTask class is the base of the range Tasks,
+         *        by which a nested tdl::parallel_for() finds the Task
+         *        the enclosing loop's range Tasks are children of.
+         */
+        class LoopTask : public Task {};
+
+        /**
+         * @brief The RangeTask class executes the loop body on a
+         *        subrange of tdl::parallel_for(). Split halves are
+         *        spawned as children of the RangeTask's parent, so
+         *        the parent finishes when the whole range is done.
+         */
+        template <class Iterator, class Body>
+        class RangeTask final : public LoopTask {
+        public:
+            RangeTask(Iterator first, Iterator last, std::size_t grain_size, bool lazy,
+                      std::shared_ptr<Body> body, std::size_t *slot = nullptr)
+                : m_first(first),
+                  m_last(last),
+                  m_grain_size(grain_size),
+                  m_lazy(lazy),
+                  m_body(std::move(body)),
+                  m_slot(slot)
+            {}
+
+        private:
+            using is_index = typename std::is_integral<Iterator>::type;
+
+            virtual void execute() override {
+                // Recording the executing worker for affinity_partitioner
+                if (m_slot != nullptr) *m_slot = current_worker_index();
+
+                // Splitting the range while idle workers take the halves
+                if (m_lazy) {
+                    Worker *worker = Worker::current();
+                    while (static_cast<std::size_t>(m_last - m_first) > m_grain_size) {
+                        if (worker->task_count() == 0) {
+                            split();
+                            continue;
+                        }
+                        Iterator chunk_end = m_first + m_grain_size;
+                        apply_body(m_first, chunk_end, *m_body, is_index());
+                        m_first = chunk_end;
+                    }
+                }
+
+                apply_body(m_first, m_last, *m_body, is_index());
+            }
+
+            void split() {
+                Iterator middle = m_first + (m_last - m_first) / 2;
+                spawn_child(task_ptr(new RangeTask(middle, m_last, m_grain_size, true, m_body)),
+                            get_parent());
+                m_last = middle;
+            }
+
+            Iterator                m_first;
+            Iterator                m_last;
+            std::size_t             m_grain_size;
+            bool                    m_lazy;
+            std::shared_ptr<Body>   m_body;
+            std::size_t            *m_slot;
+        };
+
+        /**
+         * @brief Calls the distributing function with the Task the
+         *        range Tasks are spawned under. Inside a Task this is
+         *        the caller, otherwise the range is processed under a
+         *        submitted Task, and the caller blocks until it's done.
+         *        Inside the body of another loop it is the parent of
+         *        that loop's range Tasks: a parent only waits for the
+         *        execution of it's children, so the enclosing loop
+         *        would finish before the nested ranges otherwise.
+         */
+        template <class Function>
+        void distribute(const Function &function) {
+            Worker *worker = Worker::current();
+            if (worker != nullptr && worker->current_task() != nullptr) {
+                const task_ptr &caller = worker->current_task();
+                task_ptr parent = caller->get_parent();
+                if (parent != nullptr && dynamic_cast<const LoopTask*>(caller.get()) != nullptr) {
+                    function(parent);
+                    return;
+                }
+                function(caller);
+                return;
+            }
+
+            // Blocking outside of Task execution
+            task_ptr root = discards([&function]() {
+                function(Worker::current()->current_task());
+            });
+            submit(root);
+            root->wait();
+        }
+
+        /**
+         * @brief Divides [first; last) into chunks of almost equal
+         *        size, and calls the function with the index and
+         *        bounds of each chunk.
+         */
+        template <class Iterator, class Function>
+        void for_each_chunk(Iterator first, Iterator last, std::size_t chunks, const Function &function) {
+            std::size_t range   = static_cast<std::size_t>(last - first);
+            std::size_t minimum = range / chunks;
+            std::size_t excess  = range % chunks;
+
+            for (std::size_t i = 0; i < chunks; i++) {
+                Iterator chunk_end = first + (minimum + (i < excess ? 1 : 0));
+                function(i, first, chunk_end);
+                first = chunk_end;
+            }
+        }
+
+        /**
+         * @brief Returns the number of chunks a range is divided
+         *        into: one per worker, but not below grain size.
+         */
+        std::size_t chunk_count(std::size_t range, std::size_t grain_size);
+
+    } // namespace detail
+
+    /**
+     * @brief   Applies the body to each element of [first; last) in
+     *          parallel, splitting the range according to the
+     *          partitioner.
+     * @details The iterators must be random access iterators or
+     *          integral indices. The body is called with the index
+     *          for integral ranges, and with the dereferenced
+     *          iterator otherwise; it is called concurrently, and is
+     *          copied once. Inside a Task the range Tasks are spawned
+     *          as children of the caller and the call returns
+     *          immediately: the caller (and it's continuation)
+     *          finishes after the whole range is processed. Loops
+     *          nested in the body of another loop are spawned under
+     *          the caller of the outermost one, which finishes after
+     *          the nested ranges too. Outside of Tasks the call
+     *          blocks until the range is processed.
+     * @param   Begin of the range.
+     * @param   End of the range.
+     * @param   The loop body.
+     * @param   The partitioner. (default: tdl::auto_partitioner)
+     */
+    template <class Iterator, class Body>
+    void parallel_for(Iterator first, Iterator last, const Body &body,
+                      const auto_partitioner &partitioner = auto_partitioner()) {
+        if (!(first < last)) return;
+
+        using body_type  = typename std::decay<Body>::type;
+        using range_task = detail::RangeTask<Iterator, body_type>;
+        auto shared_body = std::make_shared<body_type>(body);
+        std::size_t grain_size = partitioner.grain_size();
+
+        detail::distribute([&](const task_ptr &parent) {
+            detail::spawn_child(task_ptr(new range_task(first, last, grain_size, true, shared_body)),
+                                parent);
+        });
+    }
+
+    template <class Iterator, class Body>
+    void parallel_for(Iterator first, Iterator last, const Body &body,
+                      const static_partitioner &partitioner) {
+        if (!(first < last)) return;
+
+        using body_type  = typename std::decay<Body>::type;
+        using range_task = detail::RangeTask<Iterator, body_type>;
+        auto shared_body = std::make_shared<body_type>(body);
+        std::size_t grain_size = partitioner.grain_size();
+        std::size_t chunks = detail::chunk_count(last - first, grain_size);
+
+        detail::distribute([&](const task_ptr &parent) {
+            // Submitting chunk i to worker i
+            detail::for_each_chunk(first, last, chunks, [&](std::size_t i, Iterator begin, Iterator end) {
+                task_ptr chunk(new range_task(begin, end, grain_size, false, shared_body));
+                chunk->set_parent(parent);
+                parent->increment_refcount();
+                detail::submit_to(i, chunk);
+            });
+        });
+    }
+
+    template <class Iterator, class Body>
+    void parallel_for(Iterator first, Iterator last, const Body &body,
+                      affinity_partitioner &partitioner) {
+        if (!(first < last)) return;
+
+        using body_type  = typename std::decay<Body>::type;
+        using range_task = detail::RangeTask<Iterator, body_type>;
+        auto shared_body = std::make_shared<body_type>(body);
+        std::size_t grain_size = partitioner.grain_size();
+        std::size_t chunks = detail::chunk_count(last - first, grain_size);
+        std::vector<std::size_t> &slots = partitioner.slots(chunks);
+        std::size_t workers = detail::current_worker_count();
+
+        detail::distribute([&](const task_ptr &parent) {
+            detail::for_each_chunk(first, last, chunks, [&](std::size_t i, Iterator begin, Iterator end) {
+                std::size_t recorded = slots[i];
+                task_ptr chunk(new range_task(begin, end, grain_size, true, shared_body, &slots[i]));
+
+                // Spawning chunks without a recorded worker, to be stolen
+                if (recorded >= workers) {
+                    detail::spawn_child(chunk, parent);
+                    return;
+                }
+
+                // Submitting the chunk to the recorded worker
+                chunk->set_parent(parent);
+                parent->increment_refcount();
+                detail::submit_to(recorded, chunk);
+            });
+        });
+    }
+
+} // namespace tdl
+
+#endif // PARALLEL_H
@@ -0,0 +1,129 @@
+#include "pool.h"
+
+#include <new>
+
+namespace tdl {
+
+    namespace detail {
+
+        namespace {
+
+            // Pool parameters
+            constexpr std::size_t granularity   = 64;
+            constexpr std::size_t class_count   = 8;
+            constexpr std::size_t max_cached    = 1024;
+
+            /**
+             * @brief The free_block struct links cached blocks
+             *        into a singly linked free list.
+             */
+            struct free_block {
+                free_block *next;
+            };
+
+            /**
+             * @brief The thread_cache struct holds the free lists
+             *        of a thread. It is trivially destructible, so it
+             *        remains accessible while other thread-local and
+             *        static objects are destroyed; cache_releaser
+             *        flushes it at thread exit.
+             */
+            struct thread_cache {
+                enum state_t { unused, active, released };
+
+                free_block  *lists[class_count];
+                std::size_t  counts[class_count];
+                state_t      state;
+            };
+
+            thread_local thread_cache s_cache;
+
+            /**
+             * @brief The cache_releaser struct returns the blocks
+             *        cached by a thread to the global heap when the
+             *        thread exits.
+             */
+            struct cache_releaser {
+                ~cache_releaser() {
+                    for (std::size_t i = 0; i < class_count; i++) {
+                        while (s_cache.lists[i] != nullptr) {
+                            free_block *block = s_cache.lists[i];
+                            s_cache.lists[i] = block->next;
+                            ::operator delete(block);
+                        }
+                        s_cache.counts[i] = 0;
+                    }
+                    s_cache.state = thread_cache::released;
+                }
+            };
+
+            thread_local cache_releaser s_releaser;
+
+            /** Returns the size class serving the requested size. */
+            std::size_t size_class(std::size_t size) {
+                return (size + granularity - 1) / granularity - 1;
+            }
+
+            /** Returns true if the thread's cache can be used. */
+            bool cache_usable() {
+                if (s_cache.state == thread_cache::active) return true;
+                if (s_cache.state == thread_cache::released) return false;
+
+                // Registering the releaser on first use
+                (void)&s_releaser;
+                s_cache.state = thread_cache::active;
+                return true;
+            }
+
+        } // namespace
+
+        void *pool_allocate(std::size_t size) {
+            std::size_t index = size_class(size);
+
+            // Serving from the free list if possible
+            if (index < class_count && cache_usable()) {
+                free_block *block = s_cache.lists[index];
+                if (block != nullptr) {
+                    s_cache.lists[index] = block->next;
+                    s_cache.counts[index]--;
+                    return block;
+                }
+                return ::operator new((index + 1) * granularity);
+            }
+
+            return ::operator new(size);
+        }
+
+        void pool_deallocate(void *block, std::size_t size) noexcept {
+            std::size_t index = size_class(size);
+
+            // Caching the block on the freeing thread
+            if (index < class_count && cache_usable() && s_cache.counts[index] < max_cached) {
+                free_block *freed = static_cast<free_block*>(block);
+                freed->next = s_cache.lists[index];
+                s_cache.lists[index] = freed;
+                s_cache.counts[index]++;
+                return;
+            }
+
+            ::operator delete(block);
+        }
+
+#if defined(__cpp_aligned_new)
+        void *pool_allocate(std::size_t size, std::align_val_t alignment) {
+            if (static_cast<std::size_t>(alignment) <= pool_alignment)
+                return pool_allocate(size);
+            return ::operator new(size, alignment);
+        }
+
+        void pool_deallocate(void *block, std::size_t size, std::align_val_t alignment) noexcept {
+            if (static_cast<std::size_t>(alignment) <= pool_alignment)
+                pool_deallocate(block, size);
+            else
+                ::operator delete(block, alignment);
+        }
+#endif
+
+    } // namespace detail
+
+} // namespace tdl
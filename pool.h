@@ -0,0 +1,79 @@
+#pragma once
+#ifndef POOL_H
+#define POOL_H
+
+#include <new>
+#include <cstddef>
+
+namespace tdl {
+
+    namespace detail {
+
+        /**
+         * @brief The alignment of the blocks returned by pool_allocate()
+         *        (the alignment guaranteed by the global operator new).
+         */
+        constexpr std::size_t pool_alignment = alignof(std::max_align_t);
+
+        /**
+         * @brief   Allocates a block of at least the requested size
+         *          from the calling thread's free lists.
+         * @details Blocks are grouped into size classes of 64 bytes
+         *          up to 512 bytes, larger requests are served by the
+         *          global operator new. Freed blocks are cached on the
+         *          thread that frees them (not the one that allocated
+         *          them), so Tasks are recycled by the worker that
+         *          finishes them. Each list caches a bounded number of
+         *          blocks, the rest is returned to the global heap.
+         * @param   The requested size in bytes.
+         */
+        void *pool_allocate(std::size_t size);
+
+        /**
+         * @brief Returns a block obtained from pool_allocate() to
+         *        the calling thread's free lists.
+         * @param Pointer to the block.
+         * @param The size passed to pool_allocate().
+         */
+        void pool_deallocate(void *block, std::size_t size) noexcept;
+
+#if defined(__cpp_aligned_new)
+        /**
+         * @brief Allocates a block of at least the requested size and
+         *        alignment. Alignments up to pool_alignment are served
+         *        from the free lists, larger ones by the global aligned
+         *        operator new.
+         * @param The requested size in bytes.
+         * @param The requested alignment.
+         */
+        void *pool_allocate(std::size_t size, std::align_val_t alignment);
+
+        /**
+         * @brief Returns a block obtained from the aligned
+         *        pool_allocate().
+         * @param Pointer to the block.
+         * @param The size passed to pool_allocate().
+         * @param The alignment passed to pool_allocate().
+         */
+        void pool_deallocate(void *block, std::size_t size, std::align_val_t alignment) noexcept;
+#endif
+
+        /**
+         * @brief True if Tasks of the given type are correctly aligned
+         *        by Task::operator new: always with aligned new
+         *        (C++17), otherwise if the type is not over-aligned.
+         */
+        template <class TaskType>
+        constexpr bool pool_aligned() {
+#if defined(__cpp_aligned_new)
+            return true;
+#else
+            return alignof(TaskType) <= pool_alignment;
+#endif
+        }
+
+    } // namespace detail
+
+} // namespace tdl
+
+#endif // POOL_H
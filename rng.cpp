@@ -0,0 +1,40 @@
+#include "rng.h"
+
+#include <atomic>
+#include <chrono>
+
+namespace tdl {
+
+    namespace detail {
+
+        namespace {
+
+            /** Counter distinguishing the seeds of threads. */
+            std::atomic<std::uint64_t> s_seed_counter {0};
+
+            std::uint64_t splitmix64(std::uint64_t value) {
+                value += 0x9E3779B97F4A7C15ull;
+                value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+                value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+                return value ^ (value >> 31);
+            }
+
+        } // namespace
+
+        fast_rng::fast_rng(std::uint64_t seed)
+            : m_state(splitmix64(seed))
+        {
+            // Avoiding the all-zero state of xorshift
+            if (m_state == 0) m_state = 0x9E3779B97F4A7C15ull;
+        }
+
+        fast_rng& thread_rng() {
+            static thread_local fast_rng s_generator(
+                static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()) ^
+                (s_seed_counter.fetch_add(1, std::memory_order_relaxed) << 32));
+            return s_generator;
+        }
+
+    } // namespace detail
+
+} // namespace tdl
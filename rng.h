@@ -0,0 +1,60 @@
+#pragma once
+#ifndef RNG_H
+#define RNG_H
+
+#include <cstdint>
+#include <cstddef>
+
+namespace tdl {
+
+    namespace detail {
+
+        /**
+         * @brief   The fast_rng class is a small xorshift64*
+         *          pseudo-random generator, used for choosing
+         *          victims and workers.
+         * @details Unlike std::rand() it holds no lock and no
+         *          shared state, so every thread uses it's own
+         *          instance (see tdl::detail::thread_rng()).
+         */
+        class fast_rng final {
+        public:
+            /**
+             * @brief Constructs a generator from the seed,
+             *        scrambled by splitmix64 (any seed is valid).
+             */
+            explicit fast_rng(std::uint64_t seed);
+
+            /** Returns the next 64 bit pseudo-random value. */
+            std::uint64_t next() {
+                m_state ^= m_state >> 12;
+                m_state ^= m_state << 25;
+                m_state ^= m_state >> 27;
+                return m_state * 0x2545F4914F6CDD1Dull;
+            }
+
+            /**
+             * @brief Returns a pseudo-random value in [0; bound),
+             *        using the high bits (no division).
+             * @param The exclusive upper bound, greater than 0.
+             */
+            std::size_t below(std::size_t bound) {
+                std::uint64_t high = next() >> 32;
+                return static_cast<std::size_t>((high * static_cast<std::uint64_t>(bound)) >> 32);
+            }
+
+        private:
+            std::uint64_t m_state;
+        };
+
+        /**
+         * @brief Returns the generator of the calling thread,
+         *        seeded differently for every thread.
+         */
+        fast_rng& thread_rng();
+
+    } // namespace detail
+
+} // namespace tdl
+
+#endif // RNG_H
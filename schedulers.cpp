@@ -1,5 +1,7 @@
-#include <random>
+#include <algorithm>
 #include "schedulers.h"
+#include "rng.h"
+#include "task.h"
 
 namespace tdl {
 
@@ -14,21 +16,80 @@ namespace tdl {
     workerlist_t::iterator round_robin_scheduler::operator()(workerlist_t::iterator begin,
                                                              workerlist_t::iterator end)
     {
-        static std::size_t counter = 1;
-        std::size_t index = counter++ % (end-begin);
+        static std::atomic<std::size_t> counter {1};
+        std::size_t index = counter.fetch_add(1, std::memory_order_relaxed) % (end-begin);
         return (begin + index);
     }
 
-    random_scheduler::random_scheduler(){
-        std::srand(std::time(nullptr));
-    }
-
     workerlist_t::iterator random_scheduler::operator()(workerlist_t::iterator begin,
                                                         workerlist_t::iterator end)
     {
-        std::size_t index = std::rand() % (end-begin);
+        std::size_t index = detail::thread_rng().below(end-begin);
         return (begin + index);
     }
 
+    workerlist_t::iterator power_of_two_scheduler::operator()(workerlist_t::iterator begin,
+                                                              workerlist_t::iterator end)
+    {
+        // Sampling two workers
+        detail::fast_rng &rng = detail::thread_rng();
+        auto first  = begin + rng.below(end-begin);
+        auto second = begin + rng.below(end-begin);
+
+        return (*second)->task_count() < (*first)->task_count() ? second : first;
+    }
+
+    hash_affinity_scheduler::hash_affinity_scheduler(std::size_t overload_threshold)
+        : m_overload_threshold(overload_threshold)
+    {}
+
+    workerlist_t::iterator hash_affinity_scheduler::operator()(workerlist_t::iterator begin,
+                                                               workerlist_t::iterator end,
+                                                               const task_ptr &task)
+    {
+        // Placing Tasks without a key by load
+        if (task == nullptr || task->get_affinity_key() == no_affinity_key)
+            return power_of_two_scheduler()(begin, end);
+
+        // Selecting the home worker by Fibonacci hashing of the key
+        std::uint64_t hash = static_cast<std::uint64_t>(task->get_affinity_key()) * 0x9E3779B97F4A7C15ull;
+        std::uint64_t count = static_cast<std::uint64_t>(end - begin);
+        auto home = begin + static_cast<std::size_t>(((hash >> 32) * count) >> 32);
+
+        // Spilling over if the home worker is overloaded
+        if ((*home)->task_count() >= m_overload_threshold)
+            return power_of_two_scheduler()(begin, end);
+        return home;
+    }
+
+    least_loaded_scheduler::least_loaded_scheduler()
+        : m_cache(std::make_shared<cache>())
+    {}
+
+    workerlist_t::iterator least_loaded_scheduler::operator()(workerlist_t::iterator begin,
+                                                              workerlist_t::iterator end)
+    {
+        std::size_t count  = end - begin;
+        std::size_t cached = m_cache->index.load(std::memory_order_relaxed);
+
+        // Comparing the cached worker to two random ones
+        std::size_t least  = cached % count;
+        std::size_t length = begin[least]->task_count();
+        for (int i = 0; i < 2; i++) {
+            std::size_t sample = detail::thread_rng().below(count);
+            std::size_t sample_length = begin[sample]->task_count();
+            if (sample_length < length) {
+                least  = sample;
+                length = sample_length;
+            }
+        }
+
+        // Publishing the shorter queue, unless another
+        // submission has replaced the cached worker since
+        if (least != cached)
+            m_cache->index.compare_exchange_strong(cached, least, std::memory_order_relaxed);
+        return begin + least;
+    }
+
 } // namespace tdl
 
@@ -2,6 +2,11 @@
 #ifndef SCHEDULERS_H
 #define SCHEDULERS_H
 
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <type_traits>
+
 #include "dispatcher.h"
 #include "types.h"
 
@@ -13,6 +18,9 @@ namespace tdl {
      *        and implements a load balancing scheduling algorithm.
      *        The algorithm performs naive distribution and picks
      *        the worker with the least amount of active Tasks.
+     *        It reads the queue length of every worker, costing
+     *        O(n) per submission (see power_of_two_scheduler and
+     *        least_loaded_scheduler for cheaper alternatives).
      */
     struct load_balancing_scheduler final {
         /**
@@ -28,7 +36,10 @@ namespace tdl {
      * @brief The round_robin_scheduler struct is a
      *        functor which can be passed to tdl::set_scheduler(),
      *        and implements a round-robin scheduling algorithm.
-     *        The algorithm picks the next worker in sequence.
+     *        The algorithm picks the next worker in sequence,
+     *        using an atomic counter shared by all instances,
+     *        so concurrent submissions do not skip or repeat
+     *        workers.
      */
     struct round_robin_scheduler final {
         /**
@@ -44,24 +55,195 @@ namespace tdl {
      * @brief The random_scheduler struct is a
      *        functor which can be passed to tdl::set_scheduler(),
      *        and implements a random scheduling algorithm.
-     *        The algorithm picks the next worker at random.
+     *        The algorithm picks the next worker at random,
+     *        using the lock-free generator of the calling
+     *        thread (see tdl::detail::thread_rng()).
      */
     struct random_scheduler final {
         /**
-         * @brief Constructs a random_scheduler object.
-         *        Used to seed the random-generator.
+         * @brief Returns an iterator to a random worker.
+         * @param Iterator to the first element.
+         * @param Iterator to the last element.
          */
-        random_scheduler();
+        workerlist_t::iterator operator()(workerlist_t::iterator begin,
+                                          workerlist_t::iterator end);
+    };
 
+    /**
+     * @brief The power_of_two_scheduler struct is a functor
+     *        which can be passed to tdl::set_scheduler(), and
+     *        implements the power of two choices algorithm.
+     *        The algorithm picks two workers at random, and
+     *        selects the one with fewer queued Tasks. This
+     *        balances load nearly as well as a full scan at O(1)
+     *        cost per submission.
+     */
+    struct power_of_two_scheduler final {
         /**
-         * @brief Returns an iterator to a random worker.
+         * @brief Returns an iterator to the less busy of two
+         *        random workers.
+         * @param Iterator to the first element.
+         * @param Iterator to the last element.
+         */
+        workerlist_t::iterator operator()(workerlist_t::iterator begin,
+                                          workerlist_t::iterator end);
+    };
+
+    /**
+     * @brief   The hash_affinity_scheduler struct is a functor
+     *          which can be passed to tdl::set_scheduler(), and
+     *          keeps Tasks with equal affinity keys on the same
+     *          worker (see tdl::Task::set_affinity_key()).
+     * @details The home worker of a key is selected by hashing it.
+     *          If the home worker has at least overload_threshold
+     *          queued Tasks, or the Task has no key, the worker is
+     *          selected by tdl::power_of_two_scheduler instead.
+     */
+    struct hash_affinity_scheduler final {
+        /**
+         * @brief Constructs a hash_affinity_scheduler object.
+         * @param The queue length from which the home worker is
+         *        considered overloaded. (default: 64)
+         */
+        explicit hash_affinity_scheduler(std::size_t overload_threshold = 64);
+
+        /**
+         * @brief Returns an iterator to the home worker of the
+         *        Task's affinity key, unless it is overloaded.
+         * @param Iterator to the first element.
+         * @param Iterator to the last element.
+         * @param The Task being placed.
+         */
+        workerlist_t::iterator operator()(workerlist_t::iterator begin,
+                                          workerlist_t::iterator end,
+                                          const task_ptr &task);
+
+    private:
+        std::size_t m_overload_threshold;
+    };
+
+    /**
+     * @brief   The least_loaded_scheduler struct is a functor
+     *          which can be passed to tdl::set_scheduler(), and
+     *          picks the least busy worker using a cached minimum.
+     * @details Each submission compares the cached worker to two
+     *          random workers, and picks the one with the fewest
+     *          queued Tasks. If a sampled worker is picked, it is
+     *          published as the new cached minimum with a CAS, so
+     *          a concurrent submission that already replaced it
+     *          is not overwritten. The cost per submission is O(1)
+     *          regardless of the worker count. Copies of the
+     *          functor share the cache.
+     */
+    struct least_loaded_scheduler final {
+        /**
+         * @brief Constructs a least_loaded_scheduler object.
+         */
+        least_loaded_scheduler();
+
+        /**
+         * @brief Returns an iterator to the (approximately)
+         *        least busy worker.
          * @param Iterator to the first element.
          * @param Iterator to the last element.
          */
         workerlist_t::iterator operator()(workerlist_t::iterator begin,
                                           workerlist_t::iterator end);
+
+    private:
+        /**
+         * @brief The cache struct is shared by the copies of
+         *        the functor stored by the dispatcher.
+         */
+        struct cache {
+            std::atomic<std::size_t> index {0};
+        };
+
+        std::shared_ptr<cache>  m_cache;
     };
 
+    namespace detail {
+
+        /**
+         * @brief The receives_task struct checks if a scheduler
+         *        can be called with the Task being placed.
+         */
+        template <class Scheduler, class = void>
+        struct receives_task : std::false_type {};
+
+        template <class Scheduler>
+        struct receives_task<Scheduler, decltype(void(std::declval<Scheduler&>()(
+            std::declval<workerlist_t::iterator>(),
+            std::declval<workerlist_t::iterator>(),
+            std::declval<const task_ptr&>())))> : std::true_type {};
+
+        /**
+         * @brief The legacy_scheduler struct adapts a scheduler
+         *        receiving only the range of workers to the
+         *        tdl::scheduler_t contract, ignoring the Task.
+         */
+        template <class Scheduler>
+        struct legacy_scheduler {
+            workerlist_t::iterator operator()(workerlist_t::iterator begin,
+                                              workerlist_t::iterator end,
+                                              const task_ptr&) {
+                return scheduler(begin, end);
+            }
+
+            Scheduler scheduler;
+        };
+
+        template <class Scheduler>
+        scheduler_t to_scheduler(Scheduler scheduler, std::true_type) {
+            return scheduler_t(std::move(scheduler));
+        }
+
+        template <class Scheduler>
+        scheduler_t to_scheduler(Scheduler scheduler, std::false_type) {
+            return scheduler_t(legacy_scheduler<Scheduler> {std::move(scheduler)});
+        }
+
+        template <class Scheduler>
+        workerlist_t::iterator invoke_scheduler(Scheduler &scheduler,
+                                                workerlist_t::iterator begin,
+                                                workerlist_t::iterator end,
+                                                const task_ptr &task,
+                                                std::true_type) {
+            return scheduler(begin, end, task);
+        }
+
+        template <class Scheduler>
+        workerlist_t::iterator invoke_scheduler(Scheduler &scheduler,
+                                                workerlist_t::iterator begin,
+                                                workerlist_t::iterator end,
+                                                const task_ptr&,
+                                                std::false_type) {
+            return scheduler(begin, end);
+        }
+
+        /**
+         * @brief Calls a scheduler directly (without tdl::scheduler_t),
+         *        passing the Task only if the scheduler receives it.
+         */
+        template <class Scheduler>
+        workerlist_t::iterator invoke_scheduler(Scheduler &scheduler,
+                                                workerlist_t::iterator begin,
+                                                workerlist_t::iterator end,
+                                                const task_ptr &task) {
+            return invoke_scheduler(scheduler, begin, end, task, receives_task<Scheduler>());
+        }
+
+        /**
+         * @brief Converts a scheduler to tdl::scheduler_t, adapting
+         *        schedulers that only receive the range of workers.
+         */
+        template <class Scheduler>
+        scheduler_t to_scheduler(Scheduler scheduler) {
+            return to_scheduler(std::move(scheduler), receives_task<Scheduler>());
+        }
+
+    } // namespace detail
+
 } // namespace tdl
 
 #endif // SCHEDULERS_H
@@ -0,0 +1,92 @@
+#include "stats.h"
+
+#include <algorithm>
+
+namespace tdl {
+
+    namespace detail {
+
+#if !defined(TDL_DISABLE_STATS)
+
+        namespace {
+
+            /** Returns the current time in nanoseconds (never 0). */
+            std::int64_t now() {
+                using namespace std::chrono;
+                return std::max<std::int64_t>(1, duration_cast<nanoseconds>(
+                    steady_clock::now().time_since_epoch()).count());
+            }
+
+            /** Returns the time elapsed since a timestamp, or 0 if unset. */
+            std::uint64_t elapsed(std::int64_t since, std::int64_t current) {
+                return since == 0 || current < since ? 0 : static_cast<std::uint64_t>(current - since);
+            }
+
+        } // namespace
+
+        void worker_counters::start() {
+            m_busy = false;
+            m_idle_since.store(now(), std::memory_order_relaxed);
+        }
+
+        void worker_counters::stop() {
+            // Accounting the time of the current state
+            std::int64_t current = now();
+            add(m_busy ? m_busy_ns : m_idle_ns,
+                elapsed((m_busy ? m_busy_since : m_idle_since).load(std::memory_order_relaxed), current));
+            m_busy_since.store(0, std::memory_order_relaxed);
+            m_idle_since.store(0, std::memory_order_relaxed);
+            m_busy = false;
+        }
+
+        void worker_counters::switch_state(bool busy) {
+            std::int64_t current = now();
+            if (busy) {
+                add(m_idle_ns, elapsed(m_idle_since.load(std::memory_order_relaxed), current));
+                m_idle_since.store(0, std::memory_order_relaxed);
+                m_busy_since.store(current, std::memory_order_relaxed);
+            }
+            else {
+                add(m_busy_ns, elapsed(m_busy_since.load(std::memory_order_relaxed), current));
+                m_busy_since.store(0, std::memory_order_relaxed);
+                m_idle_since.store(current, std::memory_order_relaxed);
+            }
+            m_busy = busy;
+        }
+
+        worker_stats worker_counters::snapshot() const {
+            worker_stats stats;
+            stats.executed        = m_executed.load(std::memory_order_relaxed);
+            stats.spawned         = m_spawned.load(std::memory_order_relaxed);
+            stats.submitted       = m_submitted.load(std::memory_order_relaxed);
+            stats.steal_attempts  = m_steal_attempts.load(std::memory_order_relaxed);
+            stats.steals          = m_steals.load(std::memory_order_relaxed);
+            stats.failed_steals   = m_failed_steals.load(std::memory_order_relaxed);
+            stats.max_queue_depth = m_max_queue_depth.load(std::memory_order_relaxed);
+
+            // Including the time spent in the current state
+            std::int64_t current = now();
+            stats.idle_time = std::chrono::nanoseconds(m_idle_ns.load(std::memory_order_relaxed) +
+                elapsed(m_idle_since.load(std::memory_order_relaxed), current));
+            stats.busy_time = std::chrono::nanoseconds(m_busy_ns.load(std::memory_order_relaxed) +
+                elapsed(m_busy_since.load(std::memory_order_relaxed), current));
+            return stats;
+        }
+
+#endif
+
+        void accumulate(worker_stats &sum, const worker_stats &stats) {
+            sum.executed        += stats.executed;
+            sum.spawned         += stats.spawned;
+            sum.submitted       += stats.submitted;
+            sum.steal_attempts  += stats.steal_attempts;
+            sum.steals          += stats.steals;
+            sum.failed_steals   += stats.failed_steals;
+            sum.idle_time       += stats.idle_time;
+            sum.busy_time       += stats.busy_time;
+            sum.max_queue_depth  = std::max(sum.max_queue_depth, stats.max_queue_depth);
+        }
+
+    } // namespace detail
+
+} // namespace tdl
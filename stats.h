@@ -0,0 +1,178 @@
+#pragma once
+#ifndef STATS_H
+#define STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace tdl {
+
+    /**
+     * @brief True if the runtime statistics are compiled in. Building
+     *        the library and the application with TDL_DISABLE_STATS
+     *        defined removes the counters, and tdl::stats() returns
+     *        zeros.
+     */
+#if defined(TDL_DISABLE_STATS)
+    constexpr bool stats_enabled = false;
+#else
+    constexpr bool stats_enabled = true;
+#endif
+
+    /**
+     * @brief   The worker_stats struct holds the counters of a worker
+     *          since it was created, or their sum (see tdl::stats()).
+     * @details Busy time runs from the moment a worker finds a Task
+     *          until it runs out of Tasks, idle time covers spinning
+     *          and parking in between. The maximum queue depth is
+     *          observed when the worker pushes to it's deque, or
+     *          drains it's injection queue into it.
+     */
+    struct worker_stats {
+        std::uint64_t               executed        = 0;    // Tasks executed
+        std::uint64_t               spawned         = 0;    // Tasks spawned to the worker's deque
+        std::uint64_t               submitted       = 0;    // Tasks submitted to the worker
+        std::uint64_t               steal_attempts  = 0;    // Attempts to steal from a victim
+        std::uint64_t               steals          = 0;    // Successful attempts
+        std::uint64_t               failed_steals   = 0;    // Attempts finding nothing
+        std::chrono::nanoseconds    idle_time       {0};    // Time without Tasks
+        std::chrono::nanoseconds    busy_time       {0};    // Time executing Tasks
+        std::size_t                 max_queue_depth = 0;    // Largest observed queue length
+    };
+
+    /**
+     * @brief The pool_stats struct is a snapshot of the counters of
+     *        all workers. The entries of workers are indexed like
+     *        tdl::detail::submit_to(), the main thread worker is
+     *        reported separately, and total is the sum of both
+     *        (with the largest queue depth).
+     */
+    struct pool_stats {
+        std::vector<worker_stats>   workers;
+        worker_stats                main;
+        worker_stats                total;
+    };
+
+    namespace detail {
+
+        /**
+         * @brief   The worker_counters class holds the counters of
+         *          a Worker. Apart from submissions, all counters are
+         *          written by the worker's own thread only, so they
+         *          are updated with relaxed loads and stores (no
+         *          atomic read-modify-write), and read concurrently
+         *          by snapshot().
+         * @details Time is only taken when the worker switches
+         *          between busy and idle. With TDL_DISABLE_STATS all
+         *          methods are empty.
+         */
+        class worker_counters final {
+        public:
+            worker_counters() = default;
+
+            /** Copying the counters is forbidden. */
+            worker_counters(const worker_counters&) = delete;
+            worker_counters& operator=(const worker_counters&) = delete;
+
+#if defined(TDL_DISABLE_STATS)
+            void executed() {}
+            void spawned(std::size_t) {}
+            void submitted(std::size_t) {}
+            void steal(bool) {}
+            void queue_depth(std::size_t) {}
+            void start() {}
+            void stop() {}
+            void busy() {}
+            void idle() {}
+            worker_stats snapshot() const { return worker_stats(); }
+#else
+            /** Counts an executed Task. */
+            void executed() {
+                add(m_executed, 1);
+            }
+
+            /** Counts Tasks spawned by the worker. */
+            void spawned(std::size_t count) {
+                add(m_spawned, count);
+            }
+
+            /** Counts Tasks submitted to the worker (from any thread). */
+            void submitted(std::size_t count) {
+                m_submitted.fetch_add(count, std::memory_order_relaxed);
+            }
+
+            /** Counts a steal attempt and it's outcome. */
+            void steal(bool success) {
+                add(m_steal_attempts, 1);
+                add(success ? m_steals : m_failed_steals, 1);
+            }
+
+            /** Records the queue length if it is the largest so far. */
+            void queue_depth(std::size_t depth) {
+                if (depth > m_max_queue_depth.load(std::memory_order_relaxed))
+                    m_max_queue_depth.store(depth, std::memory_order_relaxed);
+            }
+
+            /** Starts accounting time, when the worker loop starts (idle). */
+            void start();
+
+            /** Stops accounting time, when the worker loop exits. */
+            void stop();
+
+            /** Switches to busy when the worker found a Task. */
+            void busy() {
+                if (!m_busy) switch_state(true);
+            }
+
+            /** Switches to idle when the worker found no Task. */
+            void idle() {
+                if (m_busy) switch_state(false);
+            }
+
+            /**
+             * @brief Returns the current values. The time spent in
+             *        the current state is included.
+             */
+            worker_stats snapshot() const;
+
+        private:
+            using counter_t = std::atomic<std::uint64_t>;
+
+            /** Adds to a counter written by the owner thread only. */
+            static void add(counter_t &counter, std::uint64_t value) {
+                counter.store(counter.load(std::memory_order_relaxed) + value,
+                              std::memory_order_relaxed);
+            }
+
+            /** Accounts the time of the left state. */
+            void switch_state(bool busy);
+
+            bool                        m_busy = false;
+            counter_t                   m_executed {0};
+            counter_t                   m_spawned {0};
+            counter_t                   m_submitted {0};
+            counter_t                   m_steal_attempts {0};
+            counter_t                   m_steals {0};
+            counter_t                   m_failed_steals {0};
+            counter_t                   m_idle_ns {0};
+            counter_t                   m_busy_ns {0};
+            std::atomic<std::int64_t>   m_idle_since {0};
+            std::atomic<std::int64_t>   m_busy_since {0};
+            std::atomic<std::size_t>    m_max_queue_depth {0};
+#endif
+        };
+
+        /**
+         * @brief Adds the counters of a worker to the sum, keeping
+         *        the largest queue depth.
+         */
+        void accumulate(worker_stats &sum, const worker_stats &stats);
+
+    } // namespace detail
+
+} // namespace tdl
+
+#endif // STATS_H
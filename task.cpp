@@ -1,21 +1,92 @@
 #include "task.h"
+#include "pool.h"
+#include "futex.h"
+#include "trace.h"
 #include "tdl.h"
 
+#include <limits>
+
 namespace tdl {
 
+    namespace {
+
+        // Low bit of m_successors marking a finished Task
+        constexpr std::uintptr_t successors_closed = 1;
+
+        // High bit of m_pending held until the first predecessor
+        // of a join_mode::any Task finishes
+        constexpr std::uint32_t any_pending = 0x80000000u;
+
+        /** Bit of the reference count set by blocked waiters. */
+        constexpr std::uint32_t refcount_waiting = 0x80000000u;
+        constexpr std::uint32_t refcount_mask    = ~refcount_waiting;
+
+    } // namespace
+
     std::atomic_uint Task::s_task_id_counter {0};
 
     Task::Task()
+        : Task(join_mode::all)
+    {}
+
+    Task::Task(join_mode mode)
         : m_task_id(++s_task_id_counter),
           m_refcount(1),
           m_parent(nullptr),
           m_continuation(nullptr),
-          m_affinity(thread_affinity::none)
+          m_affinity(thread_affinity::none),
+          m_affinity_key(no_affinity_key),
+          m_tag(0),
+          m_enqueued(0),
+          m_use_count(0),
+          m_pending(mode == join_mode::any ? any_pending + 1 : 1),
+          m_successors(0),
+          m_join_mode(mode),
+          m_retain_successors(false),
+          m_next_injected(nullptr)
     {}
 
+    Task::~Task() {
+        // Releasing successor links of an unfinished Task
+        Edge *edge = reinterpret_cast<Edge*>(m_successors.load(std::memory_order_relaxed) & ~successors_closed);
+        while (edge != nullptr) {
+            Edge *next = edge->next;
+            delete edge;
+            edge = next;
+        }
+    }
+
+    void *Task::operator new(std::size_t size) {
+        return detail::pool_allocate(size);
+    }
+
+    void Task::operator delete(void *block, std::size_t size) noexcept {
+        detail::pool_deallocate(block, size);
+    }
+
+#if defined(__cpp_aligned_new)
+    void *Task::operator new(std::size_t size, std::align_val_t alignment) {
+        return detail::pool_allocate(size, alignment);
+    }
+
+    void Task::operator delete(void *block, std::size_t size, std::align_val_t alignment) noexcept {
+        detail::pool_deallocate(block, size, alignment);
+    }
+#endif
+
+    void *Task::Edge::operator new(std::size_t size) {
+        return detail::pool_allocate(size);
+    }
+
+    void Task::Edge::operator delete(void *block, std::size_t size) noexcept {
+        detail::pool_deallocate(block, size);
+    }
+
     void Task::process() {
         // Executing task
+        detail::trace(trace_event::begin, m_task_id);
         execute();
+        detail::trace(trace_event::end, m_task_id);
 
         // Decrementing parent refcount
         if (m_parent != nullptr)
@@ -26,10 +97,30 @@ namespace tdl {
     }
 
     void Task::wait() {
-        std::unique_lock<std::mutex> lock(m_mutex);
-        m_wait_cv.wait(lock, [this](){
-            return m_refcount == 0;
-        });
+        // Executing other Tasks while waiting on a worker
+        Worker *worker = Worker::current();
+        if (worker != nullptr) {
+            while ((m_refcount.load(std::memory_order_acquire) & refcount_mask) != 0) {
+                if (!worker->run_one()) std::this_thread::yield();
+            }
+            return;
+        }
+
+        // Blocking outside of workers
+        std::uint32_t refcount = m_refcount.load(std::memory_order_acquire);
+        while ((refcount & refcount_mask) != 0) {
+            // Registering as a waiter before blocking
+            if (!(refcount & refcount_waiting)) {
+                if (!m_refcount.compare_exchange_weak(refcount, refcount | refcount_waiting,
+                                                      std::memory_order_acq_rel,
+                                                      std::memory_order_acquire))
+                    continue;
+                refcount |= refcount_waiting;
+            }
+
+            detail::futex_wait(m_refcount, refcount);
+            refcount = m_refcount.load(std::memory_order_acquire);
+        }
     }
 
     std::size_t Task::get_id() const {
@@ -37,7 +128,7 @@ namespace tdl {
     }
 
     std::size_t Task::get_refcount() const {
-        return m_refcount;
+        return m_refcount.load(std::memory_order_relaxed) & refcount_mask;
     }
 
     task_ptr Task::get_parent() const {
@@ -52,11 +143,19 @@ namespace tdl {
         return m_affinity;
     }
 
-    void Task::set_parent(task_ptr parent) {
+    std::size_t Task::get_affinity_key() const {
+        return m_affinity_key;
+    }
+
+    std::uint32_t Task::get_tag() const {
+        return m_tag;
+    }
+
+    void Task::set_parent(const task_ptr &parent) {
         m_parent = parent;
     }
 
-    task_ptr Task::set_continuation(task_ptr continuation) {
+    task_ptr Task::set_continuation(const task_ptr &continuation) {
         m_continuation = continuation;
         return continuation;
     }
@@ -65,19 +164,148 @@ namespace tdl {
         m_affinity = affinity;
     }
 
-    void Task::increment_refcount() {
-        m_refcount++;
+    void Task::set_affinity_key(std::size_t key) {
+        m_affinity_key = key;
+    }
+
+    void Task::set_affinity_address(const void *address) {
+        m_affinity_key = reinterpret_cast<std::uintptr_t>(address) / 64;
+    }
+
+    void Task::set_tag(std::uint32_t tag) {
+        m_tag = tag;
+    }
+
+    task_ptr Task::precede(const task_ptr &successor) {
+        // Registering the dependency on the successor
+        if (successor->m_join_mode == join_mode::all)
+            successor->m_pending.fetch_add(1, std::memory_order_relaxed);
+
+        // Linking the successor unless this Task already finished
+        Edge *edge = new Edge {successor, nullptr};
+        std::uintptr_t head = m_successors.load(std::memory_order_acquire);
+        do {
+            if (head & successors_closed) {
+                delete edge;
+                successor->predecessor_finished();
+                return successor;
+            }
+            edge->next = reinterpret_cast<Edge*>(head);
+        } while (!m_successors.compare_exchange_weak(head, reinterpret_cast<std::uintptr_t>(edge),
+                                                     std::memory_order_release,
+                                                     std::memory_order_acquire));
+
+        return successor;
+    }
+
+    bool Task::release_dependency() {
+        // Skipping the decrement when no dependency is left
+        if (m_pending.load(std::memory_order_acquire) == 1) return true;
+        return m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    }
+
+    void Task::predecessor_finished() {
+        bool ready = false;
+
+        if (m_join_mode == join_mode::any) {
+            // Only the first finishing predecessor counts
+            std::uint32_t previous = m_pending.fetch_and(~any_pending, std::memory_order_acq_rel);
+            ready = (previous == any_pending);
+        } else {
+            ready = (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1);
+        }
+
+        // Pushing the Task to the finishing worker
+        if (ready) tdl::detail::push_task(task_ptr(this));
+    }
+
+    void Task::release_successors() {
+        // Closing the list, later successors are released immediately
+        std::uintptr_t head = m_successors.fetch_or(successors_closed, std::memory_order_acq_rel);
+
+        // Keeping the links of graph nodes for the next execution
+        Edge *edge = reinterpret_cast<Edge*>(head);
+        if (m_retain_successors) {
+            for (; edge != nullptr; edge = edge->next)
+                edge->successor->predecessor_finished();
+            return;
+        }
+
+        while (edge != nullptr) {
+            Edge *next = edge->next;
+            edge->successor->predecessor_finished();
+            delete edge;
+            edge = next;
+        }
+        m_successors.store(successors_closed, std::memory_order_release);
+    }
+
+    void Task::reset(std::uint32_t predecessors) {
+        m_refcount = 1;
+
+        // Nodes without predecessors are released by submission,
+        // others by their predecessors only
+        if (predecessors == 0)
+            m_pending = 1;
+        else if (m_join_mode == join_mode::any)
+            m_pending = any_pending;
+        else
+            m_pending = predecessors;
+
+        m_successors.fetch_and(~successors_closed, std::memory_order_acq_rel);
+    }
+
+    void Task::reopen_successors() {
+        m_successors.fetch_and(~successors_closed, std::memory_order_acq_rel);
+    }
+
+    void Task::remove_successor(const Task *successor) {
+        // Unlinking the matching edges, keeping the closed flag
+        std::uintptr_t head = m_successors.load(std::memory_order_acquire);
+        std::uintptr_t closed = head & successors_closed;
+        Edge *kept = nullptr;
+        Edge *edge = reinterpret_cast<Edge*>(head & ~successors_closed);
+        while (edge != nullptr) {
+            Edge *next = edge->next;
+            if (edge->successor.get() == successor) {
+                delete edge;
+            } else {
+                edge->next = kept;
+                kept = edge;
+            }
+            edge = next;
+        }
+
+        // Restoring the original order of the kept edges
+        Edge *ordered = nullptr;
+        while (kept != nullptr) {
+            Edge *next = kept->next;
+            kept->next = ordered;
+            ordered = kept;
+            kept = next;
+        }
+        m_successors.store(reinterpret_cast<std::uintptr_t>(ordered) | closed, std::memory_order_release);
+    }
+
+    void Task::increment_refcount(std::uint32_t count) {
+        m_refcount.fetch_add(count, std::memory_order_relaxed);
     }
 
     void Task::decrement_refcount() {
-        if (--m_refcount == 0) {
+        std::uint32_t previous = m_refcount.fetch_sub(1, std::memory_order_acq_rel);
+        if ((previous & refcount_mask) == 1) {
             // Pushing continuation
-            if (m_continuation != nullptr) {
+            if (m_continuation != nullptr && m_continuation->release_dependency()) {
+                detail::trace(trace_event::continuation, m_continuation->get_id());
                 tdl::detail::push_task(m_continuation);
             }
 
-            // Waking up threads waiting for completion
-            m_wait_cv.notify_all();
+            // Releasing successors
+            release_successors();
+
+            // Waking up threads blocked in wait()
+            if (previous & refcount_waiting)
+                detail::futex_wake(m_refcount, std::numeric_limits<std::size_t>::max());
         }
     }
 
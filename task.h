@@ -2,9 +2,10 @@
 #ifndef TASK_H
 #define TASK_H
 
+#include <new>
 #include <atomic>
 #include <memory>
-#include <condition_variable>
+#include <cstdint>
 
 #include "types.h"
 
@@ -18,23 +19,54 @@ namespace tdl {
      */
     enum class thread_affinity { main, none };
 
+    /**
+     * @brief Tasks with predecessors can join in two modes:
+     *        with join_mode::all the Task becomes ready when all
+     *        predecessors finished, with join_mode::any when the
+     *        first one finished. See tdl::when_all(), tdl::when_any().
+     */
+    enum class join_mode { all, any };
+
+    /**
+     * @brief The affinity key of Tasks without a locality hint.
+     *        See tdl::Task::set_affinity_key().
+     */
+    constexpr std::size_t no_affinity_key = static_cast<std::size_t>(-1);
+
     /**
      * @brief The Task class represents a piece of work to
      *        be done. It is the central concept in the TDL
-     *        library.
+     *        library. Tasks are reference counted intrusively
+     *        (see tdl::task_ptr), and their storage is served
+     *        by per-thread free lists (see tdl::detail::pool_allocate()).
      */
     class Task {
     public:
         /** Constucts a Task object. */
         Task();
 
-        /** Virtual destructor for derived classes. */
-        virtual ~Task() = default;
+        /** Releases the successor links not yet processed. */
+        virtual ~Task();
 
         /** Copying a task is forbidden. */
         Task(const Task&) = delete;
         Task& operator=(const Task&) = delete;
 
+        /**
+         * @brief Allocation functions recycling the storage of
+         *        Tasks (including derived types) on the freeing
+         *        thread. Over-aligned Tasks use the aligned
+         *        overloads with C++17, and are rejected by the
+         *        library's factories otherwise (see
+         *        tdl::detail::pool_aligned()).
+         */
+        static void *operator new(std::size_t size);
+        static void operator delete(void *block, std::size_t size) noexcept;
+#if defined(__cpp_aligned_new)
+        static void *operator new(std::size_t size, std::align_val_t alignment);
+        static void operator delete(void *block, std::size_t size, std::align_val_t alignment) noexcept;
+#endif
+
         /**
          * @brief Executes the Task, then decrements
          *        the reference count of the parent
@@ -44,11 +76,14 @@ namespace tdl {
         void process();
 
         /**
-         * @brief Blocks the current thread until the
-         *        Task is finished. Calling wait() during
-         *        Task execution is not adviced, as it
-         *        prevents the worker from processing
-         *        other Tasks in the meantime.
+         * @brief   Blocks the current thread until the
+         *          Task is finished.
+         * @details When called during Task execution, the
+         *          worker keeps executing other Tasks (its
+         *          own, or stolen ones) until the Task is
+         *          finished, so nested waits do not take
+         *          workers away from the pool. A Task must
+         *          not wait for itself or its parent.
          */
         void wait();
 
@@ -58,19 +93,74 @@ namespace tdl {
         task_ptr            get_parent() const;
         task_ptr            get_continuation() const;
         thread_affinity     get_thread_affinity() const;
+        std::size_t         get_affinity_key() const;
+        std::uint32_t       get_tag() const;
 
         /** Setters for Task properties. */
-        task_ptr    set_continuation(task_ptr continuation);
-        void        set_parent(task_ptr parent);
+        task_ptr    set_continuation(const task_ptr &continuation);
+        void        set_parent(const task_ptr &parent);
         void        set_thread_affinity(thread_affinity affinity);
 
+        /**
+         * @brief Sets a locality hint passed to the scheduler with
+         *        the Task: Tasks with equal keys (for example the
+         *        same shard) can be kept on the same worker. See
+         *        tdl::hash_affinity_scheduler.
+         * @param The key (tdl::no_affinity_key removes the hint).
+         */
+        void        set_affinity_key(std::size_t key);
+
+        /**
+         * @brief Sets the affinity key from the address of the
+         *        data the Task works on. Addresses in the same
+         *        cache line give equal keys.
+         * @param Address of the data.
+         */
+        void        set_affinity_address(const void *address);
+
+        /**
+         * @brief Sets the tag under which the latencies of the Task
+         *        are recorded, see tdl::set_latency_tracking(). Tags
+         *        group Tasks of the same kind, e.g. request handlers.
+         * @param The tag, below tdl::max_task_tags. (default: 0)
+         */
+        void        set_tag(std::uint32_t tag);
+
+        /**
+         * @brief   Adds the supplied Task as a successor of
+         *          this Task: the successor will not be executed
+         *          before this Task finishes (it's reference count
+         *          reaches zero).
+         * @details A Task can have any number of predecessors and
+         *          successors. A Task with unfinished predecessors
+         *          may be submitted or spawned, it is held back and
+         *          pushed to the queue of the worker finishing it's
+         *          last predecessor. Adding a successor to an already
+         *          finished Task has no effect on the successor.
+         *          Predecessors should be added before the successor
+         *          is submitted.
+         * @param   The successor Task.
+         * @return  The successor Task, to allow chaining.
+         */
+        task_ptr precede(const task_ptr &successor);
+
+        /**
+         * @brief  Releases one dependency of the Task. Submitting
+         *         or spawning a Task releases one dependency, and
+         *         each finishing predecessor releases one more.
+         * @return True if the Task became ready for execution
+         *         and should be scheduled by the caller.
+         */
+        bool release_dependency();
+
         /**
          * @brief Increments the reference count of the
          *        Task. Used when spawning child Tasks,
          *        to increase the reference count of the
          *        parent.
+         * @param The number of children spawned. (default: 1)
          */
-        void increment_refcount();
+        void increment_refcount(std::uint32_t count = 1);
 
         /**
          * @brief Decrements the reference count of the
@@ -83,14 +173,84 @@ namespace tdl {
          */
         void decrement_refcount();
 
+    protected:
+        /**
+         * @brief Constructs a Task joining it's predecessors
+         *        in the given mode.
+         */
+        explicit Task(join_mode mode);
+
     private:
-        std::size_t             m_task_id;
-        std::atomic_uint        m_refcount;
-        std::condition_variable m_wait_cv;
-        std::mutex              m_mutex;
-        task_ptr                m_parent;
-        task_ptr                m_continuation;
-        thread_affinity         m_affinity;
+        /**
+         * @brief The Edge struct links a successor into the
+         *        lock-free successor list of a Task.
+         */
+        struct Edge {
+            task_ptr    successor;
+            Edge       *next;
+
+            static void *operator new(std::size_t size);
+            static void operator delete(void *block, std::size_t size) noexcept;
+        };
+
+        /**
+         * @brief Notifies the Task that one of it's predecessors
+         *        finished, and pushes it to the calling worker if
+         *        it became ready.
+         */
+        void predecessor_finished();
+
+        /**
+         * @brief Closes the successor list and notifies all
+         *        successors. Called when the Task finishes.
+         */
+        void release_successors();
+
+        /**
+         * @brief Prepares a finished Task of a tdl::graph for
+         *        another execution: restores the reference count,
+         *        the number of pending predecessors and reopens the
+         *        successor list.
+         * @param The number of predecessors in the graph.
+         */
+        void reset(std::uint32_t predecessors);
+
+        /**
+         * @brief Reopens the successor list closed by the last
+         *        execution, so successors added afterwards are
+         *        linked. Used by tdl::graph between executions.
+         */
+        void reopen_successors();
+
+        /**
+         * @brief Removes the links to the supplied successor.
+         *        Must not be called while the Task may finish.
+         */
+        void remove_successor(const Task *successor);
+
+        /** Graphs reset their nodes and edit the successor lists. */
+        friend class graph;
+
+        /** The injection queues link Tasks through m_next_injected. */
+        friend class InjectionQueue;
+
+        /** Workers timestamp queued Tasks through m_enqueued. */
+        friend class Worker;
+
+        std::size_t                 m_task_id;
+        std::atomic<std::uint32_t>  m_refcount;
+        task_ptr                    m_parent;
+        task_ptr                    m_continuation;
+        thread_affinity             m_affinity;
+        std::size_t                 m_affinity_key;
+        std::uint32_t               m_tag;
+        std::int64_t                m_enqueued;
+        std::atomic<std::uint32_t>  m_use_count;
+        std::atomic<std::uint32_t>  m_pending;
+        std::atomic<std::uintptr_t> m_successors;
+        join_mode                   m_join_mode;
+        bool                        m_retain_successors;
+        Task                       *m_next_injected;
 
         /** Task ID generator. */
         static std::atomic_uint s_task_id_counter;
@@ -101,6 +261,24 @@ namespace tdl {
          *        the Task's functionality.
          */
         virtual void execute() = 0;
+
+        /**
+         * @brief Increments the number of tdl::task_ptr
+         *        references to the Task.
+         */
+        friend void intrusive_retain(Task *task) noexcept {
+            task->m_use_count.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Decrements the number of tdl::task_ptr
+         *        references to the Task, and destroys it
+         *        when the last reference is released.
+         */
+        friend void intrusive_release(Task *task) noexcept {
+            if (task->m_use_count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                delete task;
+        }
     };
 
 } // namespace tdl
@@ -18,6 +18,50 @@ namespace tdl {
         return detail::get_dispatcher().get_worker_count();
     }
 
+    void set_max_worker_count(std::size_t count) {
+        detail::get_dispatcher().set_max_worker_count(count);
+    }
+
+    std::size_t get_max_worker_count() {
+        return detail::get_dispatcher().get_max_worker_count();
+    }
+
+    concurrency_info get_available_concurrency() {
+        return detail::get_dispatcher().get_available_concurrency();
+    }
+
+    void set_steal_mode(steal_mode mode) {
+        detail::get_dispatcher().set_steal_mode(mode);
+    }
+
+    steal_mode get_steal_mode() {
+        return detail::get_dispatcher().get_steal_mode();
+    }
+
+    void set_idle_policy(idle_policy policy) {
+        detail::get_dispatcher().set_idle_policy(policy);
+    }
+
+    idle_policy get_idle_policy() {
+        return detail::get_dispatcher().get_idle_policy();
+    }
+
+    void set_pinning(bool enabled) {
+        detail::get_dispatcher().set_pinning(enabled);
+    }
+
+    bool get_pinning() {
+        return detail::get_dispatcher().get_pinning();
+    }
+
+    void set_victim_policy(victim_policy policy) {
+        detail::get_dispatcher().set_victim_policy(policy);
+    }
+
+    victim_policy get_victim_policy() {
+        return detail::get_dispatcher().get_victim_policy();
+    }
+
     void initialize() {
         detail::get_dispatcher().initialize();
     }
@@ -31,18 +75,32 @@ namespace tdl {
         detail::get_dispatcher().shutdown();
     }
 
-    void submit(task_ptr task) {
-        if(task != nullptr) {
-            detail::initialization_check();
-            detail::get_dispatcher().submit(task);
-        }
+    void submit(const task_ptr &task) {
+        if(task != nullptr)
+            detail::current_pool().submit(task);
     }
 
-    void spawn(task_ptr task) {
-        if(task != nullptr) {
-            detail::initialization_check();
-            detail::get_dispatcher().spawn(task);
-        }
+    void spawn(const task_ptr &task) {
+        if(task != nullptr)
+            detail::current_pool().spawn(task);
+    }
+
+    void submit_bulk(const std::vector<task_ptr> &tasks) {
+        if(!tasks.empty())
+            detail::current_pool().submit_bulk(tasks);
+    }
+
+    void spawn_bulk(const std::vector<task_ptr> &tasks) {
+        if(!tasks.empty())
+            detail::current_pool().spawn_bulk(tasks);
+    }
+
+    pool_stats stats() {
+        return detail::get_dispatcher().stats();
+    }
+
+    std::map<std::uint32_t, latency_stats> latency() {
+        return detail::get_dispatcher().latency();
     }
 
     void process_main() {
@@ -81,19 +139,53 @@ namespace tdl {
             return s_dispatcher;
         }
 
-        void push_task(task_ptr task) {
+        WorkerPool& current_pool() {
+            // Routing to the owner of the calling worker
+            Worker *worker = Worker::current();
+            if (worker != nullptr && worker->owner() != nullptr)
+                return *worker->owner();
+
+            initialization_check();
+            return get_dispatcher();
+        }
+
+        std::size_t current_worker_count() {
+            return current_pool().worker_count();
+        }
+
+        void push_task(const task_ptr &task) {
             if(task != nullptr)
-                detail::get_dispatcher().push_task(task);
+                current_pool().push_task(task);
         }
 
-        worker_ptr current_worker() {
+        Worker* current_worker() {
             return detail::get_dispatcher().current_worker();
         }
 
+        void spawn_child(const task_ptr &task, const task_ptr &parent) {
+            if(task != nullptr)
+                current_pool().spawn(task, parent);
+        }
+
+        void submit_to(std::size_t index, const task_ptr &task) {
+            if(task != nullptr)
+                current_pool().submit_to(index, task);
+        }
+
+        std::size_t current_worker_index() {
+            Worker *worker = Worker::current();
+            return worker == nullptr ? no_worker : worker->index();
+        }
+
         worker_ptr choose_victim() {
             return detail::get_dispatcher().choose_victim();
         }
 
+        bool wait_for_work(std::chrono::microseconds timeout,
+                           std::chrono::microseconds idle_time) {
+            return detail::get_dispatcher().wait_for_work(timeout, idle_time);
+        }
+
         void initialization_check() {
             if (!get_dispatcher().initialized())
                 throw initialization_exception();
@@ -2,14 +2,25 @@
 #ifndef TDL_H
 #define TDL_H
 
+#include <vector>
+
 #include "types.h"
 #include "task.h"
 #include "worker.h"
 #include "dispatcher.h"
+#include "topology.h"
+#include "stats.h"
+#include "latency.h"
+#include "trace.h"
 #include "make.h"
 #include "callables.h"
 #include "schedulers.h"
 #include "exceptions.h"
+#include "future.h"
+#include "dependencies.h"
+#include "graph.h"
+#include "parallel.h"
+#include "basic_pool.h"
 
 /**
  * Namespace tdl groups all functionality and types
@@ -22,24 +33,129 @@ namespace tdl {
      * @brief Sets the global scheduler algorithm for TDL.
      *        This call is only effective prior to initialization.
      * @param A Callable object or function convertible
-     *        to tdl::scheduler_t. See types.h for details.
+     *        to tdl::scheduler_t, or to tdl::legacy_scheduler_t.
+     *        See types.h for details.
      *        (default: tdl::load_balancing_scheduler)
      */
     void set_scheduler(scheduler_t scheduler);
 
     /**
-     * @brief Sets the count of worker threads to create
-     *        upon initialization. This call is only effective
-     *        prior to initialization.
-     * @param The number of workers (default: std::hardware_concurrency())
+     * @brief Sets the global scheduler algorithm for TDL, adapting
+     *        schedulers which only receive the range of workers.
+     */
+    template <class Scheduler>
+    void set_scheduler(Scheduler scheduler) {
+        set_scheduler(detail::to_scheduler(std::move(scheduler)));
+    }
+
+    /**
+     * @brief   Sets the number of workers Tasks are scheduled to.
+     *          Can be called at any time to grow or shrink the pool.
+     * @details Worker threads are started on demand, when Tasks are
+     *          submitted to them or spawned while no worker is idle.
+     *          Workers beyond the count finish their Tasks and exit
+     *          their threads. As workers are created upon
+     *          initialization, the pool can only grow up to
+     *          get_max_worker_count() afterwards: larger counts throw
+     *          tdl::worker_count_exception. To grow beyond the
+     *          available concurrency, call set_max_worker_count()
+     *          before initialization.
+     * @param   The number of workers (default: get_available_concurrency())
      */
     void set_worker_count(std::size_t count);
 
     /**
-     * @brief Returns the number of worker threads.
+     * @brief Returns the number of workers Tasks are scheduled to.
      */
     std::size_t get_worker_count();
 
+    /**
+     * @brief Sets the number of workers created upon initialization,
+     *        the upper limit of set_worker_count(). This call is only
+     *        effective prior to initialization.
+     * @param The maximum number of workers, raised to the worker
+     *        count if lower. (default: get_available_concurrency())
+     */
+    void set_max_worker_count(std::size_t count);
+
+    /**
+     * @brief Returns the maximum number of workers.
+     */
+    std::size_t get_max_worker_count();
+
+    /**
+     * @brief   Returns the number of CPUs the process can use, and
+     *          the limit it was derived from. Detected once at
+     *          startup (see tdl::detail::detect_concurrency()).
+     * @details Inside containers this is the CPU quota of the cgroup
+     *          (rounded up) rather than the CPUs of the host, so the
+     *          default pool is not throttled by the scheduler.
+     */
+    concurrency_info get_available_concurrency();
+
+    /**
+     * @brief Sets how idle workers steal Tasks from others.
+     *        This call is only effective prior to initialization.
+     * @param With tdl::steal_mode::single a thief takes one Task
+     *        per steal, with tdl::steal_mode::half it also moves
+     *        half of the victim's remaining Tasks into it's own
+     *        queue. (default: tdl::steal_mode::half)
+     */
+    void set_steal_mode(steal_mode mode);
+
+    /**
+     * @brief Returns the steal mode of the workers.
+     */
+    steal_mode get_steal_mode();
+
+    /**
+     * @brief Sets how idle workers wait for new Tasks.
+     *        This call is only effective prior to initialization.
+     * @param The number of failed steal attempts before an idle
+     *        worker parks, the maximum time it stays parked
+     *        without being notified of new work, and the time
+     *        after which an idle worker exits it's thread.
+     *        (default: 64 attempts, 100 milliseconds, never)
+     */
+    void set_idle_policy(idle_policy policy);
+
+    /**
+     * @brief Returns the idle policy of the workers.
+     */
+    idle_policy get_idle_policy();
+
+    /**
+     * @brief   Enables pinning each worker thread to a logical CPU.
+     *          This call is only effective prior to initialization.
+     * @details The CPUs the process may run on are read from
+     *          /sys/devices/system/cpu (see tdl::detail::detect_topology()).
+     *          Workers are placed on distinct physical cores first,
+     *          neighbouring workers sharing caches, and on SMT
+     *          siblings only when cores run out. (default: false)
+     * @param   True to pin workers.
+     */
+    void set_pinning(bool enabled);
+
+    /**
+     * @brief Returns true if workers are pinned to CPUs.
+     */
+    bool get_pinning();
+
+    /**
+     * @brief   Sets how workers choose victims to steal from.
+     *          This call is only effective prior to initialization.
+     * @details The hierarchical policy only applies to pinned
+     *          workers, unpinned workers always choose randomly.
+     *          (default: tdl::victim_policy::hierarchical)
+     * @param   The victim selection policy.
+     */
+    void set_victim_policy(victim_policy policy);
+
+    /**
+     * @brief Returns the victim selection policy.
+     */
+    victim_policy get_victim_policy();
+
     /**
      * @brief   Initializes TDL.
      * @details TDL must be initialized before use by calling
@@ -73,10 +189,29 @@ namespace tdl {
      *          scheduling.
      * @details Invokes the scheduler to decide which worker
      *          should handle the supplied task and assigns
-     *          it to the worker for later execution.
+     *          it to the worker for later execution. A task
+     *          with unfinished predecessors is held back, and
+     *          pushed by the worker finishing the last one
+     *          (see tdl::Task::precede()). Called from a Task
+     *          executed by a tdl::basic_pool, the task is submitted
+     *          to that pool instead (see tdl::WorkerPool), as are
+     *          the tasks of the other submitting and spawning
+     *          functions.
      * @param   Task to be scheduled (of type tdl::task_ptr).
      */
-    void submit(task_ptr task);
+    void submit(const task_ptr &task);
+
+    /**
+     * @brief   Submits a batch of tasks, as if each was passed
+     *          to tdl::submit().
+     * @details The scheduler is called once, and the batch is
+     *          dealt to the workers in contiguous slices, queued
+     *          with one operation per worker. Tasks with unfinished
+     *          predecessors are held back, Tasks with main thread
+     *          affinity are submitted to the main thread.
+     * @param   Tasks to be scheduled (must not be nullptr).
+     */
+    void submit_bulk(const std::vector<task_ptr> &tasks);
 
     /**
      * @brief   When inside an executing task's body, spawns
@@ -90,7 +225,44 @@ namespace tdl {
      *          being thrown.
      * @param   Task to be spawned as a child of the caller.
      */
-    void spawn(task_ptr task);
+    void spawn(const task_ptr &task);
+
+    /**
+     * @brief   When inside an executing task's body, spawns a batch
+     *          of tasks as children of the caller, as if each was
+     *          passed to tdl::spawn().
+     * @details The worker is looked up once, the reference count of
+     *          the caller is increased once, and the ready tasks are
+     *          pushed to the worker's deque in a single operation.
+     *          Throws tdl::task_context_exception outside of task
+     *          execution.
+     * @param   Tasks to be spawned as children of the caller
+     *          (must not be nullptr).
+     */
+    void spawn_bulk(const std::vector<task_ptr> &tasks);
+
+    /**
+     * @brief   Returns a snapshot of the counters of each worker,
+     *          and their sum (see tdl::worker_stats).
+     * @details The counters are read with relaxed loads while the
+     *          workers keep running, so a snapshot is not consistent
+     *          across counters. Returns empty statistics before
+     *          initialization, and zeros if the library is built
+     *          with TDL_DISABLE_STATS (see tdl::stats_enabled).
+     */
+    pool_stats stats();
+
+    /**
+     * @brief   Returns the latencies recorded for each Task tag,
+     *          merged over all workers (see tdl::set_latency_tracking()).
+     *          Only tags with executed Tasks are included.
+     * @details Percentiles are read from the histograms, e.g.
+     *          latency()[tag].queue_delay.percentile(99.9) is the
+     *          p999 queueing delay of the tag. Like tdl::stats(),
+     *          the histograms are read while the workers keep
+     *          recording. Returns no tags before initialization.
+     */
+    std::map<std::uint32_t, latency_stats> latency();
 
     /**
      * @brief   Processes Tasks with main-thread affinity.
@@ -153,21 +325,70 @@ namespace tdl {
          */
         Dispatcher& get_dispatcher();
 
+        /**
+         * @brief   Returns the pool owning the calling worker, or
+         *          the global pool outside of workers.
+         * @details Outside of workers throws
+         *          tdl::initialization_exception if TDL has not
+         *          been initialized.
+         */
+        WorkerPool& current_pool();
+
+        /**
+         * @brief Returns the number of workers of the current
+         *        pool (see current_pool()).
+         */
+        std::size_t current_worker_count();
+
         /**
          * @brief Pushes a task to the queue of the calling
          *        worker. Used for continuation pushing when
-         *        a task's refcount reaches zero.
+         *        a task's refcount reaches zero. If the caller
+         *        is not a worker thread, the task is submitted
+         *        through the scheduler of the global pool instead.
          * @param Task to push to the caller's queue.
          */
-        void push_task(task_ptr task);
+        void push_task(const task_ptr &task);
 
         /**
-         * @brief   Returns a tdl::task_ptr to the worker
-         *          currently executing the caller task.
+         * @brief   Returns a pointer to the worker currently
+         *          executing the caller task. The lookup is a
+         *          single thread local load.
          * @details If invoked outside of task execution
          *          context, throws tdl::task_context_exception.
          */
-        worker_ptr current_worker();
+        Worker* current_worker();
+
+        /**
+         * @brief   Spawns a task as a child of the supplied parent
+         *          instead of the calling task. The parent must be
+         *          unfinished, which is guaranteed if the caller is
+         *          one of it's (unfinished) children.
+         * @details Must be called in the context of an executing
+         *          task, otherwise throws tdl::task_context_exception.
+         * @param   Task to push to the caller's queue.
+         * @param   Parent of the task.
+         */
+        void spawn_child(const task_ptr &task, const task_ptr &parent);
+
+        /**
+         * @brief Submits a task to the worker with the given index,
+         *        bypassing the scheduler. Other workers may still
+         *        steal the task.
+         * @param Index of the worker in range [0; current_worker_count()).
+         * @param Task to submit.
+         */
+        void submit_to(std::size_t index, const task_ptr &task);
+
+        /**
+         * @brief Returns the index of the worker executing the
+         *        caller task in range [0; get_max_worker_count()),
+         *        or tdl::detail::no_worker if called outside of
+         *        workers (or from the main thread). Workers beyond
+         *        the current worker count keep their index while
+         *        they retire.
+         */
+        std::size_t current_worker_index();
 
         /**
          * @brief Returns a tdl::worker_ptr to a randomly
@@ -176,6 +397,20 @@ namespace tdl {
          */
         worker_ptr choose_victim();
 
+        /**
+         * @brief  Parks the calling worker until new Tasks are
+         *         submitted or spawned, TDL is shut down, or the
+         *         timeout expires. Returns immediately if there
+         *         are Tasks left to steal.
+         * @param  Maximum time to stay parked.
+         * @param  The time the worker has been idle.
+         * @return False if the worker retired instead, as it is
+         *         beyond the worker count or idle for longer than
+         *         the retire timeout (see tdl::idle_policy).
+         */
+        bool wait_for_work(std::chrono::microseconds timeout,
+                           std::chrono::microseconds idle_time);
+
         /**
          * @brief Checks if TDL has been initialized prior to
          *        the invocation of this method, and throws
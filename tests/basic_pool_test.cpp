@@ -0,0 +1,92 @@
+/*****************************************************************
+ * Tests that work created by Tasks of a tdl::basic_pool stays in
+ * the pool: nested tdl::parallel_for() with each partitioner,
+ * tdl::spawn() and tdl::spawn_bulk() inside pool Tasks, and bulk
+ * submission, without tdl::initialize().
+ * Returns a non-zero exit code if a check fails.
+ *
+ * Build together with the library sources (except main.cpp):
+ *   g++ -std=c++14 -O2 -pthread -I.. ../[!m]*.cpp basic_pool_test.cpp
+ ****************************************************************/
+#include <iostream>
+#include <atomic>
+#include "tdl.h"
+
+// Test parameters
+constexpr std::size_t outer   = 64;
+constexpr std::size_t inner   = 1000;
+constexpr std::size_t workers = 4;
+constexpr std::size_t spawned = 1000;
+
+int failures = 0;
+
+void check(bool condition, const char *name) {
+    std::cout << (condition ? "PASS  " : "FAIL  ") << name << std::endl;
+    if (!condition) failures++;
+}
+
+/** Runs nested parallel_for loops in a pool Task, returning the number of body calls. */
+template <class Pool, class Partitioner>
+std::size_t nested_parallel_for(Pool &pool, Partitioner &partitioner) {
+    std::atomic<std::size_t> count {0};
+    tdl::task_ptr root = tdl::discards([&]() {
+        tdl::parallel_for(std::size_t(0), outer, [&](std::size_t) {
+            tdl::parallel_for(std::size_t(0), inner, [&](std::size_t) {
+                count.fetch_add(1, std::memory_order_relaxed);
+            });
+        }, partitioner);
+    });
+    pool.submit(root);
+    root->wait();
+    return count.load();
+}
+
+int main() {
+    tdl::basic_pool<> pool(workers);
+
+    tdl::auto_partitioner automatic;
+    check(nested_parallel_for(pool, automatic) == outer * inner,
+          "nested parallel_for, auto_partitioner");
+
+    tdl::static_partitioner fixed;
+    check(nested_parallel_for(pool, fixed) == outer * inner,
+          "nested parallel_for, static_partitioner");
+
+    // Replaying the recorded workers on the later runs
+    tdl::affinity_partitioner affinity;
+    bool replayed = true;
+    for (int run = 0; run < 3; run++)
+        replayed = nested_parallel_for(pool, affinity) == outer * inner && replayed;
+    check(replayed, "nested parallel_for, affinity_partitioner");
+
+    std::atomic<std::size_t> children {0};
+    tdl::task_ptr root = tdl::discards([&]() {
+        for (std::size_t i = 0; i < spawned; i++)
+            tdl::spawn(tdl::discards([&]() { children++; }));
+    });
+    pool.submit(root);
+    root->wait();
+    check(children == spawned, "tdl::spawn() from a pool Task");
+
+    std::atomic<std::size_t> bulk_children {0};
+    root = tdl::discards([&]() {
+        std::vector<tdl::task_ptr> batch;
+        for (std::size_t i = 0; i < spawned; i++)
+            batch.push_back(tdl::discards([&]() { bulk_children++; }));
+        tdl::spawn_bulk(batch);
+    });
+    pool.submit(root);
+    root->wait();
+    check(bulk_children == spawned, "tdl::spawn_bulk() from a pool Task");
+
+    std::atomic<std::size_t> submitted {0};
+    std::vector<tdl::task_ptr> batch;
+    for (std::size_t i = 0; i < spawned; i++)
+        batch.push_back(tdl::discards([&]() { submitted++; }));
+    pool.submit_bulk(batch);
+    for (const tdl::task_ptr &task : batch) task->wait();
+    check(submitted == spawned, "basic_pool::submit_bulk()");
+
+    check(!tdl::initialized(), "global pool left uninitialized");
+    return failures == 0 ? 0 : 1;
+}
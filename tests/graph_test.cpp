@@ -0,0 +1,95 @@
+/*****************************************************************
+ * Tests tdl::graph: executions in topological order, edges and
+ * nodes added between executions, and unknown nodes. Returns a
+ * non-zero exit code if a check fails.
+ *
+ * Build together with the library sources (except main.cpp):
+ *   g++ -std=c++14 -O2 -pthread -I.. ../[!m]*.cpp graph_test.cpp
+ ****************************************************************/
+#include <iostream>
+#include <atomic>
+#include <vector>
+#include "tdl.h"
+#include "graph.h"
+#include "exceptions.h"
+
+// Test parameters
+constexpr std::size_t launches = 100;
+
+int failures = 0;
+
+void check(bool condition, const char *name) {
+    std::cout << (condition ? "PASS  " : "FAIL  ") << name << std::endl;
+    if (!condition) failures++;
+}
+
+/** a -> b, launched; then c with b -> c, launched again. */
+void test_edge_after_launch() {
+    std::vector<int> order;
+    tdl::graph graph;
+    tdl::task_ptr a = graph.emplace([&]() { order.push_back(0); });
+    tdl::task_ptr b = graph.emplace([&]() { order.push_back(1); });
+    graph.precede(a, b);
+    graph.launch();
+    graph.wait();
+    check(order == std::vector<int>({0, 1}), "first launch runs a, b");
+
+    order.clear();
+    tdl::task_ptr c = graph.emplace([&]() { order.push_back(2); });
+    graph.precede(b, c);
+    graph.launch();
+    graph.wait();
+    check(order == std::vector<int>({0, 1, 2}), "edge added after launch runs a, b, c");
+
+    order.clear();
+    graph.launch();
+    graph.wait();
+    check(order == std::vector<int>({0, 1, 2}), "third launch runs a, b, c");
+}
+
+/** A diamond launched repeatedly, counting node executions. */
+void test_repeated_launches() {
+    std::atomic<std::size_t> count {0};
+    std::atomic<bool> ordered {true};
+    std::atomic<std::size_t> middle {0};
+    tdl::graph graph;
+    tdl::task_ptr top    = graph.emplace([&]() { count++; });
+    tdl::task_ptr left   = graph.emplace([&]() { count++; middle++; });
+    tdl::task_ptr right  = graph.emplace([&]() { count++; middle++; });
+    tdl::task_ptr bottom = graph.emplace([&]() {
+        count++;
+        if (middle.exchange(0) != 2) ordered = false;
+    });
+    graph.precede(top, left);
+    graph.precede(top, right);
+    graph.precede(left, bottom);
+    graph.precede(right, bottom);
+    for (std::size_t i = 0; i < launches; i++) {
+        graph.launch();
+        graph.wait();
+    }
+    check(count == 4 * launches, "diamond executes every node on each launch");
+    check(ordered, "diamond executes bottom after left and right");
+}
+
+/** Edges to Tasks which are not nodes of the graph throw. */
+void test_unknown_node() {
+    tdl::graph graph;
+    tdl::task_ptr node = graph.emplace([]() {});
+    tdl::task_ptr other = tdl::discards([]() {});
+    bool thrown = false;
+    try {
+        graph.precede(node, other);
+    } catch (const tdl::graph_exception&) {
+        thrown = true;
+    }
+    check(thrown, "edge to an unknown node throws graph_exception");
+}
+
+int main() {
+    tdl::initialize();
+    test_edge_after_launch();
+    test_repeated_launches();
+    test_unknown_node();
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,319 @@
+#include "topology.h"
+
+#include <tuple>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <exception>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <dirent.h>
+#include <pthread.h>
+#endif
+
+namespace tdl {
+
+    bool same_core(const cpu_info &first, const cpu_info &second) {
+        return first.package == second.package && first.core == second.core;
+    }
+
+    bool same_domain(const cpu_info &first, const cpu_info &second) {
+        return first.cache == second.cache || first.node == second.node;
+    }
+
+    namespace detail {
+
+        namespace {
+
+            /** Reports hardware_concurrency() CPUs on one node. */
+            std::vector<cpu_info> fallback_topology() {
+                std::vector<cpu_info> cpus;
+                int count = static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u));
+                for (int i = 0; i < count; i++)
+                    cpus.push_back(cpu_info {i, i, 0, 0, 0, 0});
+                return cpus;
+            }
+
+#if defined(__linux__)
+
+            const std::string cpu_root = "/sys/devices/system/cpu/";
+
+            /** Returns the first line of a file, or an empty string. */
+            std::string read_line(const std::string &path) {
+                std::ifstream file(path);
+                std::string line;
+                std::getline(file, line);
+                return line;
+            }
+
+            /** Returns the integer stored in a file, or the fallback. */
+            int read_int(const std::string &path, int fallback) {
+                std::istringstream stream(read_line(path));
+                int value = fallback;
+                stream >> value;
+                return stream.fail() ? fallback : value;
+            }
+
+            /** Returns the lowest CPU sharing the last level cache. */
+            int read_cache(int cpu) {
+                int level = -1;
+                int cache = cpu;
+                for (int index = 0; ; index++) {
+                    std::string path = cpu_root + "cpu" + std::to_string(cpu) +
+                                       "/cache/index" + std::to_string(index) + "/";
+                    int current = read_int(path + "level", -1);
+                    if (current < 0) break;
+
+                    std::vector<int> shared = parse_cpu_list(read_line(path + "shared_cpu_list"));
+                    if (current >= level && !shared.empty()) {
+                        level = current;
+                        cache = shared.front();
+                    }
+                }
+                return cache;
+            }
+
+            /** Returns the number of CPUs granted by a quota, rounded up. */
+            std::size_t quota_cpus(long long quota, long long period) {
+                if (quota <= 0 || period <= 0) return 0;
+                return static_cast<std::size_t>((quota + period - 1) / period);
+            }
+
+            /** Returns the CPU limit of a cgroup v2 directory, or 0. */
+            std::size_t read_cpu_max(const std::string &directory) {
+                // Parsing "<quota> <period>", where quota may be "max"
+                std::istringstream stream(read_line(directory + "/cpu.max"));
+                std::string quota;
+                long long period = 0;
+                stream >> quota >> period;
+                if (stream.fail() || quota == "max") return 0;
+
+                std::istringstream value(quota);
+                long long microseconds = 0;
+                value >> microseconds;
+                return value.fail() ? 0 : quota_cpus(microseconds, period);
+            }
+
+            /** Returns the CPU limit of a cgroup v1 directory, or 0. */
+            std::size_t read_cfs_quota(const std::string &directory) {
+                return quota_cpus(read_int(directory + "/cpu.cfs_quota_us", -1),
+                                  read_int(directory + "/cpu.cfs_period_us", -1));
+            }
+
+            /** Returns true if the comma separated list contains the token. */
+            bool has_token(const std::string &list, const std::string &token) {
+                std::istringstream stream(list);
+                std::string item;
+                while (std::getline(stream, item, ','))
+                    if (item == token) return true;
+                return false;
+            }
+
+            /**
+             * @brief The cgroup_mount struct describes a mounted
+             *        cgroup hierarchy providing the cpu controller.
+             */
+            struct cgroup_mount {
+                std::string point;      // Mount point
+                std::string root;       // Cgroup mounted at the mount point
+                bool        v2;         // Unified (v2) hierarchy
+            };
+
+            /** Returns the cgroup hierarchies with the cpu controller. */
+            std::vector<cgroup_mount> read_cgroup_mounts() {
+                std::vector<cgroup_mount> mounts;
+                std::ifstream file("/proc/self/mountinfo");
+                std::string line;
+
+                while (std::getline(file, line)) {
+                    // Splitting at the separator of the optional fields
+                    std::size_t separator = line.find(" - ");
+                    if (separator == std::string::npos) continue;
+
+                    std::istringstream fields(line.substr(0, separator));
+                    std::string id, parent, device, root, point;
+                    fields >> id >> parent >> device >> root >> point;
+
+                    std::istringstream rest(line.substr(separator + 3));
+                    std::string type, source, options;
+                    rest >> type >> source >> options;
+
+                    if (type == "cgroup2") mounts.push_back(cgroup_mount {point, root, true});
+                    else if (type == "cgroup" && has_token(options, "cpu"))
+                        mounts.push_back(cgroup_mount {point, root, false});
+                }
+                return mounts;
+            }
+
+            /**
+             * @brief Returns the smallest CPU limit of the cgroup and
+             *        it's ancestors below the mount point, or 0 if
+             *        none is limited.
+             */
+            std::size_t cgroup_cpus(const cgroup_mount &mount, const std::string &path) {
+                // Locating the cgroup below the mount point, or using the
+                // mount point if the cgroup is outside of it (namespaces)
+                std::string relative = path;
+                if (mount.root != "/")
+                    relative = path.compare(0, mount.root.size(), mount.root) == 0 ? path.substr(mount.root.size()) : "";
+
+                std::string directory = mount.point + relative;
+                while (directory.size() > mount.point.size() && directory.back() == '/')
+                    directory.pop_back();
+
+                // Walking up to the mount point, as ancestors limit their children
+                std::size_t limit = 0;
+                while (true) {
+                    std::size_t cpus = mount.v2 ? read_cpu_max(directory) : read_cfs_quota(directory);
+                    if (cpus > 0 && (limit == 0 || cpus < limit)) limit = cpus;
+
+                    std::size_t slash = directory.rfind('/');
+                    if (slash == std::string::npos || slash < mount.point.size()) break;
+                    directory.erase(slash);
+                }
+                return limit;
+            }
+
+            /** Returns the NUMA node of the CPU (from it's nodeN link). */
+            int read_node(int cpu) {
+                DIR *directory = opendir((cpu_root + "cpu" + std::to_string(cpu)).c_str());
+                if (directory == nullptr) return 0;
+
+                int node = 0;
+                while (dirent *entry = readdir(directory)) {
+                    std::string name = entry->d_name;
+                    if (name.compare(0, 4, "node") == 0 && name.size() > 4 &&
+                        std::all_of(name.begin() + 4, name.end(), ::isdigit)) {
+                        node = std::stoi(name.substr(4));
+                        break;
+                    }
+                }
+                closedir(directory);
+                return node;
+            }
+
+#endif
+
+        } // namespace
+
+        std::vector<cpu_info> detect_topology() {
+#if defined(__linux__)
+            // Reading the online CPUs the process may run on
+            std::vector<int> online = parse_cpu_list(read_line(cpu_root + "online"));
+            cpu_set_t allowed;
+            CPU_ZERO(&allowed);
+            bool masked = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+
+            std::vector<cpu_info> cpus;
+            for (int id : online) {
+                if (masked && (id >= CPU_SETSIZE || !CPU_ISSET(id, &allowed))) continue;
+
+                std::string path = cpu_root + "cpu" + std::to_string(id) + "/topology/";
+                std::vector<int> siblings = parse_cpu_list(read_line(path + "thread_siblings_list"));
+                auto rank = std::find(siblings.begin(), siblings.end(), id);
+
+                cpu_info cpu;
+                cpu.id      = id;
+                cpu.core    = read_int(path + "core_id", id);
+                cpu.package = read_int(path + "physical_package_id", 0);
+                cpu.node    = read_node(id);
+                cpu.cache   = read_cache(id);
+                cpu.thread  = rank == siblings.end() ? 0 : static_cast<int>(rank - siblings.begin());
+                cpus.push_back(cpu);
+            }
+            if (cpus.empty()) return fallback_topology();
+
+            // Placing one thread per core first, neighbours next to each other
+            std::sort(cpus.begin(), cpus.end(), [](const cpu_info &first, const cpu_info &second) {
+                return std::tie(first.thread, first.node, first.cache, first.package, first.core, first.id) <
+                       std::tie(second.thread, second.node, second.cache, second.package, second.core, second.id);
+            });
+            return cpus;
+#else
+            return fallback_topology();
+#endif
+        }
+
+        concurrency_info detect_concurrency() {
+            concurrency_info info {std::max(std::thread::hardware_concurrency(), 1u),
+                                   concurrency_source::hardware};
+#if defined(__linux__)
+            // Counting the CPUs of the affinity mask
+            cpu_set_t allowed;
+            CPU_ZERO(&allowed);
+            if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+                std::size_t count = static_cast<std::size_t>(CPU_COUNT(&allowed));
+                if (count > 0 && count < info.count) info = {count, concurrency_source::affinity};
+            }
+
+            // Reading the cgroups of the process: "0::<path>" for v2,
+            // "<id>:<controllers>:<path>" for v1 hierarchies
+            std::string v2_path, v1_path;
+            std::ifstream file("/proc/self/cgroup");
+            std::string line;
+            while (std::getline(file, line)) {
+                std::size_t first  = line.find(':');
+                std::size_t second = line.find(':', first + 1);
+                if (first == std::string::npos || second == std::string::npos) continue;
+
+                std::string controllers = line.substr(first + 1, second - first - 1);
+                if (line.compare(0, first, "0") == 0 && controllers.empty()) v2_path = line.substr(second + 1);
+                else if (has_token(controllers, "cpu")) v1_path = line.substr(second + 1);
+            }
+
+            // Applying the quota of each hierarchy
+            for (const cgroup_mount &mount : read_cgroup_mounts()) {
+                const std::string &path = mount.v2 ? v2_path : v1_path;
+                if (path.empty()) continue;
+
+                std::size_t count = cgroup_cpus(mount, path);
+                if (count > 0 && count < info.count)
+                    info = {count, mount.v2 ? concurrency_source::cgroup_v2 : concurrency_source::cgroup_v1};
+            }
+#endif
+            return info;
+        }
+
+        std::vector<int> parse_cpu_list(const std::string &list) {
+            std::vector<int> cpus;
+            std::istringstream stream(list);
+            std::string range;
+
+            while (std::getline(stream, range, ',')) {
+                // Parsing "first" or "first-last" ranges
+                std::size_t dash = range.find('-');
+                try {
+                    int first = std::stoi(range.substr(0, dash));
+                    int last  = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+                    for (int cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+                }
+                catch (const std::exception&) {
+                    // Skipping malformed ranges
+                }
+            }
+
+            std::sort(cpus.begin(), cpus.end());
+            cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+            return cpus;
+        }
+
+        bool pin_thread(std::thread &thread, int cpu) {
+#if defined(__linux__)
+            if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            return pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+#else
+            (void)thread;
+            (void)cpu;
+            return false;
+#endif
+        }
+
+    } // namespace detail
+
+} // namespace tdl
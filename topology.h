@@ -0,0 +1,112 @@
+#pragma once
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <thread>
+#include <vector>
+#include <string>
+#include <cstddef>
+
+namespace tdl {
+
+    /**
+     * @brief Workers can choose victims to steal from in two ways:
+     *        with victim_policy::random workers sweep all others in
+     *        random order, with victim_policy::hierarchical pinned
+     *        workers try the workers on SMT siblings first, then the
+     *        workers sharing their L3 cache or NUMA node, and remote
+     *        workers only after repeated failures.
+     */
+    enum class victim_policy { random, hierarchical };
+
+    /**
+     * @brief The cpu_info struct describes the position of a
+     *        logical CPU in the machine. Fields not reported by
+     *        the system are 0.
+     */
+    struct cpu_info {
+        int id;         // Logical CPU number
+        int core;       // Physical core (unique in the package)
+        int package;    // Socket
+        int node;       // NUMA node
+        int cache;      // Lowest logical CPU sharing the last level cache
+        int thread;     // Rank among the SMT siblings of the core
+    };
+
+    /**
+     * @brief The concurrency_source enum names the limit the
+     *        available concurrency was derived from: the number of
+     *        CPUs of the machine, the process affinity mask, or the
+     *        CPU quota of the process' cgroup (v1 cpu.cfs_quota_us or
+     *        v2 cpu.max).
+     */
+    enum class concurrency_source { hardware, affinity, cgroup_v1, cgroup_v2 };
+
+    /**
+     * @brief The concurrency_info struct describes the number of
+     *        CPUs the process can use, and where it was detected.
+     */
+    struct concurrency_info {
+        std::size_t         count;      // Number of CPUs (at least 1)
+        concurrency_source  source;     // The most restrictive limit
+    };
+
+    /**
+     * @brief Returns true if both CPUs are hardware threads
+     *        of the same physical core.
+     */
+    bool same_core(const cpu_info &first, const cpu_info &second);
+
+    /**
+     * @brief Returns true if both CPUs share the last level
+     *        cache or the NUMA node.
+     */
+    bool same_domain(const cpu_info &first, const cpu_info &second);
+
+    namespace detail {
+
+        /**
+         * @brief   Returns the logical CPUs the process may run on,
+         *          ordered for placing workers: one hardware thread
+         *          of every physical core first (grouped by NUMA node
+         *          and cache), then the further SMT siblings.
+         * @details On Linux the topology is read from
+         *          /sys/devices/system/cpu, restricted to the CPUs of
+         *          the process affinity mask. Elsewhere (or if /sys is
+         *          not readable) std::thread::hardware_concurrency()
+         *          CPUs are reported on a single node.
+         */
+        std::vector<cpu_info> detect_topology();
+
+        /**
+         * @brief   Returns the number of CPUs the process can use:
+         *          the smallest of std::thread::hardware_concurrency(),
+         *          the CPUs in the process affinity mask, and the CPU
+         *          quota of it's cgroup, rounded up.
+         * @details On Linux the quota is read from the cgroup of the
+         *          process and it's ancestors, located through
+         *          /proc/self/cgroup and /proc/self/mountinfo. Both
+         *          cgroup v1 (cpu.cfs_quota_us / cpu.cfs_period_us)
+         *          and v2 (cpu.max) are supported.
+         */
+        concurrency_info detect_concurrency();
+
+        /**
+         * @brief   Parses a CPU list in the format of the kernel
+         *          (for example "0-3,8,10-11").
+         * @return  The listed CPU numbers in ascending order.
+         */
+        std::vector<int> parse_cpu_list(const std::string &list);
+
+        /**
+         * @brief  Pins the thread to the logical CPU.
+         * @return True if successful, false if pinning failed
+         *         or is not supported on the platform.
+         */
+        bool pin_thread(std::thread &thread, int cpu);
+
+    } // namespace detail
+
+} // namespace tdl
+
+#endif // TOPOLOGY_H
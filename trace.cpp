@@ -0,0 +1,184 @@
+#include "trace.h"
+
+#include <mutex>
+#include <chrono>
+#include <iomanip>
+
+namespace tdl {
+
+    namespace detail {
+
+        std::atomic<bool> s_tracing {false};
+
+        namespace {
+
+            /** Start of the trace, in steady clock nanoseconds. */
+            std::atomic<std::int64_t> s_epoch {0};
+
+            /** The buffers of all threads that recorded events. */
+            std::mutex                                  s_registry_mutex;
+            std::vector<std::shared_ptr<TraceBuffer>>   s_registry;
+
+            /** The buffer of the calling thread. */
+            thread_local std::shared_ptr<TraceBuffer>   s_buffer;
+
+            std::int64_t now() {
+                using namespace std::chrono;
+                return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+            }
+
+            /** Returns the buffer of the calling thread, registering it on first use. */
+            TraceBuffer& thread_buffer() {
+                if (s_buffer == nullptr) {
+                    std::lock_guard<std::mutex> lock(s_registry_mutex);
+                    s_buffer = std::make_shared<TraceBuffer>(s_registry.size());
+                    s_registry.push_back(s_buffer);
+                }
+                return *s_buffer;
+            }
+
+            /** Writes the common fields of a trace event. */
+            void write_event(std::ostream &out, const char *phase, std::size_t thread, std::int64_t time) {
+                out << "\"ph\":\"" << phase << "\",\"pid\":1,\"tid\":" << thread
+                    << ",\"ts\":" << static_cast<double>(time) / 1000.0;
+            }
+
+        } // namespace
+
+        TraceBuffer::TraceBuffer(std::size_t thread)
+            : m_thread(thread),
+              m_slots(new Slot[trace_capacity]),
+              m_head(0)
+        {
+            for (std::size_t i = 0; i < trace_capacity; i++)
+                m_slots[i].sequence.store(0, std::memory_order_relaxed);
+        }
+
+        void TraceBuffer::record(trace_event event, std::uint64_t task) {
+            std::uint64_t head = m_head.load(std::memory_order_relaxed);
+            Slot &slot = m_slots[head & (trace_capacity - 1)];
+
+            // Invalidating the slot before overwriting it
+            slot.sequence.store(0, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            slot.time.store(now() - s_epoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            slot.data.store(task << 8 | static_cast<std::uint64_t>(event), std::memory_order_relaxed);
+            slot.sequence.store(head + 1, std::memory_order_release);
+            m_head.store(head + 1, std::memory_order_release);
+        }
+
+        std::vector<trace_record> TraceBuffer::records() const {
+            // Copying the events published before the head was read
+            std::uint64_t head  = m_head.load(std::memory_order_acquire);
+            std::uint64_t first = head > trace_capacity ? head - trace_capacity : 0;
+
+            std::vector<trace_record> records;
+            records.reserve(head - first);
+            for (std::uint64_t i = first; i < head; i++) {
+                const Slot &slot = m_slots[i & (trace_capacity - 1)];
+                std::uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+                std::int64_t  time     = slot.time.load(std::memory_order_relaxed);
+                std::uint64_t data     = slot.data.load(std::memory_order_relaxed);
+
+                // Dropping the event if the writer overwrote it meanwhile
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (sequence != i + 1 || slot.sequence.load(std::memory_order_relaxed) != sequence)
+                    continue;
+
+                records.push_back(trace_record {time, data >> 8, static_cast<trace_event>(data & 0xFF)});
+            }
+            return records;
+        }
+
+        std::size_t TraceBuffer::thread() const {
+            return m_thread;
+        }
+
+        void record_event(trace_event event, std::uint64_t task) {
+            thread_buffer().record(event, task);
+        }
+
+    } // namespace detail
+
+    void set_tracing(bool enabled) {
+        // Setting the time origin when tracing starts first
+        std::int64_t unset = 0;
+        if (enabled) detail::s_epoch.compare_exchange_strong(unset, detail::now());
+
+        detail::s_tracing.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool get_tracing() {
+        return detail::s_tracing.load(std::memory_order_relaxed);
+    }
+
+    void write_trace(std::ostream &out) {
+        // Taking the buffers registered so far
+        std::vector<std::shared_ptr<detail::TraceBuffer>> buffers;
+        {
+            std::lock_guard<std::mutex> lock(detail::s_registry_mutex);
+            buffers = detail::s_registry;
+        }
+
+        std::ios_base::fmtflags flags = out.flags();
+        std::streamsize precision = out.precision();
+        out << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+
+        bool first = true;
+        for (const auto &buffer : buffers) {
+            std::size_t thread = buffer->thread();
+
+            // Naming the track of the thread
+            out << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+                << thread << ",\"args\":{\"name\":\"thread " << thread << "\"}}";
+            first = false;
+
+            std::size_t open_tasks = 0;
+            bool parked = false;
+            for (const detail::trace_record &record : buffer->records()) {
+                // Skipping the ends of slices begun before the retained events
+                if (record.event == trace_event::end) {
+                    if (open_tasks == 0) continue;
+                    open_tasks--;
+                }
+                if (record.event == trace_event::unpark) {
+                    if (!parked) continue;
+                    parked = false;
+                }
+                if (record.event == trace_event::begin) open_tasks++;
+                if (record.event == trace_event::park) parked = true;
+
+                out << ",\n{";
+                switch (record.event) {
+                case trace_event::begin:
+                case trace_event::end:
+                    // Task executions as slices
+                    out << "\"name\":\"task " << record.task << "\",";
+                    detail::write_event(out, record.event == trace_event::begin ? "B" : "E", thread, record.time);
+                    out << ",\"args\":{\"task\":" << record.task << "}";
+                    break;
+                case trace_event::park:
+                case trace_event::unpark:
+                    // Parked periods as slices
+                    out << "\"name\":\"parked\",";
+                    detail::write_event(out, record.event == trace_event::park ? "B" : "E", thread, record.time);
+                    break;
+                default:
+                    // Other events as instants on the thread's track
+                    out << "\"name\":\"" << (record.event == trace_event::spawn ? "spawn" :
+                                             record.event == trace_event::steal ? "steal" : "continuation") << "\",";
+                    detail::write_event(out, "i", thread, record.time);
+                    out << ",\"s\":\"t\",\"args\":{\"task\":" << record.task << "}";
+                    break;
+                }
+                out << "}";
+            }
+        }
+
+        out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+        out.flags(flags);
+        out.precision(precision);
+    }
+
+} // namespace tdl
@@ -0,0 +1,159 @@
+#pragma once
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <ostream>
+#include <cstdint>
+#include <cstddef>
+
+namespace tdl {
+
+    /**
+     * @brief The trace_event enum lists the events recorded while
+     *        tracing (see tdl::set_tracing()): the begin and end of a
+     *        Task's execution, spawning a Task, stealing a Task,
+     *        pushing a continuation, and a worker parking and
+     *        waking up.
+     */
+    enum class trace_event : std::uint8_t { begin, end, spawn, steal, continuation, park, unpark };
+
+    /**
+     * @brief   Starts or stops recording trace events.
+     * @details Each thread records to it's own ring buffer of
+     *          detail::trace_capacity events, created when it
+     *          records the first event. Buffers are kept after the
+     *          thread exits, and re-enabling tracing appends to them.
+     * @param   True to record events. (default: false)
+     */
+    void set_tracing(bool enabled);
+
+    /**
+     * @brief Returns true if trace events are recorded.
+     */
+    bool get_tracing();
+
+    /**
+     * @brief   Writes the recorded events in the Chrome trace event
+     *          JSON format, viewable in chrome://tracing or Perfetto.
+     * @details Each thread is shown as a track: Task executions and
+     *          parked periods as slices, spawns, steals and pushed
+     *          continuations as instant events, with the ID of the
+     *          Task as argument. Ends of slices whose beginning was
+     *          overwritten are omitted. May be called while tracing.
+     * @param   The stream to write to.
+     */
+    void write_trace(std::ostream &out);
+
+    namespace detail {
+
+        /** The number of events kept per thread while tracing. */
+        constexpr std::size_t trace_capacity = std::size_t(1) << 16;
+
+        /**
+         * @brief The trace_record struct is an event read from
+         *        a TraceBuffer.
+         */
+        struct trace_record {
+            std::int64_t    time;       // Nanoseconds since tracing started
+            std::uint64_t   task;       // Task ID (0 for park and unpark)
+            trace_event     event;
+        };
+
+        /**
+         * @brief   The TraceBuffer class is a lock-free ring buffer
+         *          of trace events, written by a single thread and
+         *          read concurrently by write_trace().
+         * @details When full, the oldest events are overwritten.
+         *          Each slot is a seqlock: the writer invalidates the
+         *          slot's sequence number before storing the event
+         *          and sets it to the event's index plus one after,
+         *          readers drop the events whose sequence number
+         *          changed or did not match while copying.
+         */
+        class TraceBuffer final {
+        public:
+            /**
+             * @brief Constructs an empty TraceBuffer.
+             * @param The ID of the recording thread in the trace.
+             */
+            explicit TraceBuffer(std::size_t thread);
+
+            /** Copying a buffer is forbidden. */
+            TraceBuffer(const TraceBuffer&) = delete;
+            TraceBuffer& operator=(const TraceBuffer&) = delete;
+
+            /**
+             * @brief Appends an event. Must only be called by the
+             *        thread owning the buffer.
+             */
+            void record(trace_event event, std::uint64_t task);
+
+            /**
+             * @brief Returns the retained events, oldest first.
+             *        May be called from any thread.
+             */
+            std::vector<trace_record> records() const;
+
+            /** Returns the ID of the recording thread. */
+            std::size_t thread() const;
+
+        private:
+            /**
+             * @brief The Slot struct stores an event. The task ID
+             *        and the event type share one word. The sequence
+             *        number is the index of the event plus one, or 0
+             *        while it is written.
+             */
+            struct Slot {
+                std::atomic<std::uint64_t>  sequence;
+                std::atomic<std::int64_t>   time;
+                std::atomic<std::uint64_t>  data;
+            };
+
+            std::size_t                 m_thread;
+            std::unique_ptr<Slot[]>     m_slots;
+            std::atomic<std::uint64_t>  m_head;
+        };
+
+        /** True while tracing, see tdl::set_tracing(). */
+        extern std::atomic<bool> s_tracing;
+
+        /**
+         * @brief Records an event to the calling thread's buffer,
+         *        which is created on first use.
+         */
+        void record_event(trace_event event, std::uint64_t task);
+
+        /**
+         * @brief Records an event if tracing is enabled. When
+         *        disabled this costs a relaxed load and a branch.
+         * @param The event.
+         * @param The ID of the Task (see tdl::Task::get_id()).
+         */
+        inline void trace(trace_event event, std::uint64_t task = 0) {
+            if (s_tracing.load(std::memory_order_relaxed))
+                record_event(event, task);
+        }
+
+        /**
+         * @brief Records an event for each Task of a batch if
+         *        tracing is enabled, checking it once.
+         * @param The event.
+         * @param Iterator to the first Task of the batch.
+         * @param Iterator past the last Task of the batch.
+         */
+        template <class Iterator>
+        inline void trace(trace_event event, Iterator first, Iterator last) {
+            if (s_tracing.load(std::memory_order_relaxed)) {
+                for (; first != last; ++first) record_event(event, (*first)->get_id());
+            }
+        }
+
+    } // namespace detail
+
+} // namespace tdl
+
+#endif // TRACE_H
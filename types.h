@@ -4,15 +4,21 @@
 
 #include <memory>
 #include <vector>
+#include <cstddef>
 #include <functional>
 
+#include "intrusive.h"
+
 namespace tdl {
 
     class Task;
     class Worker;
 
-    /** RAII smart pointer for referencing Tasks. */
-    using task_ptr = std::shared_ptr<Task>;
+    /**
+     * RAII smart pointer for referencing Tasks. Tasks carry
+     * their own reference count, see tdl::intrusive_ptr.
+     */
+    using task_ptr = intrusive_ptr<Task>;
 
     /** RAII smart pointer for referencing Workers. */
     using worker_ptr = std::shared_ptr<Worker>;
@@ -20,9 +26,34 @@ namespace tdl {
     /** Container type for storing Workers. */
     using workerlist_t = std::vector<worker_ptr>;
 
-    /** Callable type for storing a scheduling algorithm. */
+    /**
+     * Callable type for storing a scheduling algorithm. It receives
+     * the range of workers and the Task being placed (nullptr if
+     * there is no single Task), and returns the selected worker.
+     * Locality hints are read from the Task, see
+     * tdl::Task::get_affinity_key().
+     */
     using scheduler_t = std::function<workerlist_t::iterator(workerlist_t::iterator begin,
-                                                             workerlist_t::iterator end)>;
+                                                             workerlist_t::iterator end,
+                                                             const task_ptr &task)>;
+
+    /**
+     * Callable type of the former scheduling algorithms, which only
+     * receive the range of workers. tdl::set_scheduler() adapts them
+     * to tdl::scheduler_t.
+     */
+    using legacy_scheduler_t = std::function<workerlist_t::iterator(workerlist_t::iterator begin,
+                                                                    workerlist_t::iterator end)>;
+
+    namespace detail {
+
+        /**
+         * The index returned by tdl::detail::current_worker_index()
+         * outside of workers, never a valid worker index.
+         */
+        constexpr std::size_t no_worker = static_cast<std::size_t>(-1);
+
+    } // namespace detail
 
 } // namespace tdl
 
@@ -3,10 +3,24 @@
 
 namespace tdl {
 
-    Worker::Worker(bool is_main_worker)
+    thread_local Worker* Worker::s_current_worker {nullptr};
+
+    Worker::Worker(bool is_main_worker, steal_mode mode, idle_policy idle)
         : m_can_steal(!is_main_worker),
+          m_steal_mode(mode),
+          m_idle_policy(idle),
           m_stop_flag(false),
-          m_current_task(nullptr)
+          m_running(false),
+          m_cpu(-1),
+          m_owner(nullptr),
+          m_index(detail::no_worker),
+          m_joined(false),
+          m_current_task(nullptr),
+          m_sibling_count(0),
+          m_neighbour_count(0),
+          m_failed_steals(0),
+          m_sweep_start(0),
+          m_rng(detail::thread_rng().next())
     {
         if (is_main_worker) {
             m_thread_id = std::this_thread::get_id();
@@ -14,119 +28,339 @@ namespace tdl {
         }
     }
 
-    void Worker::start() {
+    Worker::~Worker() {
+        // Joining a thread left running
+        join();
+
+        // Releasing the references held by queued Tasks
+        Task *queued = nullptr;
+        while (m_deque.pop(queued)) {
+            from_queued(queued);
+        }
+
+        Task *injected = nullptr;
+        while ((injected = m_injected.take(m_injected.size() + 1)) != nullptr) {
+            while (injected != nullptr) {
+                queued = injected;
+                injected = InjectionQueue::next(injected);
+                from_queued(queued);
+            }
+        }
+    }
+
+    void Worker::start(int cpu) {
         // Starting thread executing do_work()
-        m_thread = std::thread(&Worker::do_work, this);
+        m_cpu = cpu;
+        m_running = true;
+        launch(std::thread(&Worker::do_work, this), cpu);
+    }
+
+    void Worker::set_cpu(int cpu) {
+        m_cpu = cpu;
+    }
+
+    bool Worker::activate() {
+        // Ordering the preceding submission before the check (see retire())
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_running.load(std::memory_order_relaxed)) return false;
+
+        // Claiming the start among concurrent callers
+        bool running = false;
+        if (!m_running.compare_exchange_strong(running, true)) return false;
+
+        // Failing once joined, under the lock join() takes
+        std::lock_guard<std::mutex> lock(m_thread_mutex);
+        if (m_joined) {
+            m_running.store(false, std::memory_order_relaxed);
+            return false;
+        }
+
+        // Joining the retired thread before replacing it
+        if (m_thread.joinable())
+            m_thread.join();
+        launch(std::thread(&Worker::do_work, this), m_cpu);
+        return true;
+    }
+
+    bool Worker::retire() {
+        // Publishing the retirement before the final check
+        m_running.store(false, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (empty()) return true;
+
+        // Resuming for Tasks submitted meanwhile, unless a
+        // submitter already claimed starting a new thread
+        bool running = false;
+        return !m_running.compare_exchange_strong(running, true);
+    }
+
+    bool Worker::running() const {
+        return m_running.load(std::memory_order_relaxed);
+    }
+
+    void Worker::launch(std::thread thread, int cpu) {
+        m_thread = std::move(thread);
+
+        // Pinning the thread if requested
+        if (cpu >= 0) detail::pin_thread(m_thread, cpu);
 
         // Assigning m_thread_id
         m_thread_id = m_thread.get_id();
     }
 
+    void Worker::set_victims(std::vector<Worker*> victims,
+                             std::size_t siblings,
+                             std::size_t neighbours)
+    {
+        m_victims         = std::move(victims);
+        m_sibling_count   = siblings;
+        m_neighbour_count = neighbours;
+    }
+
     void Worker::stop() {
         m_stop_flag = true;
     }
 
     void Worker::join() {
-        if (m_thread.joinable())
-            m_thread.join();
+        // Preventing later activations, then joining outside of the lock
+        std::thread thread;
+        {
+            std::lock_guard<std::mutex> lock(m_thread_mutex);
+            m_joined = true;
+            thread = std::move(m_thread);
+        }
+        if (thread.joinable())
+            thread.join();
     }
 
-    void Worker::lock() {
-        m_deque_guard.lock();
+    void Worker::submit(const task_ptr &task) {
+        m_injected.push(to_queued(task));
+        m_counters.submitted(1);
     }
 
-    void Worker::unlock() {
-        m_deque_guard.unlock();
-    }
+    void Worker::submit(const task_ptr *first, const task_ptr *last) {
+        if (first == last) return;
 
-    void Worker::lock_in_order(worker_ptr other) {
-        if (get_id() < other->get_id()) {
-            lock(); other->lock();
-        }
-        else {
-            other->lock(); lock();
+        // Linking the batch from the newest Task to the oldest
+        Task *oldest = to_queued(*first);
+        Task *newest = oldest;
+        for (const task_ptr *it = first + 1; it != last; it++) {
+            Task *task = to_queued(*it);
+            InjectionQueue::link(task, newest);
+            newest = task;
         }
-    }
 
-    void Worker::unlock_in_order(worker_ptr other) {
-        if (get_id() < other->get_id()) {
-            other->unlock(); unlock();
-        }
-        else {
-            unlock(); other->unlock();
-        }
+        m_injected.push(newest, oldest, last - first);
+        m_counters.submitted(last - first);
     }
 
-    void Worker::submit(task_ptr task) {
-        std::lock_guard<std::mutex> guard(m_deque_guard);
-        m_deque.push_back(task);
+    void Worker::push_task(const task_ptr &task) {
+        m_deque.push(to_queued(task));
+        m_counters.queue_depth(m_deque.size());
     }
 
-    void Worker::push_task(task_ptr task) {
-        std::lock_guard<std::mutex> guard(m_deque_guard);
-        m_deque.push_front(task);
+    void Worker::push_tasks(const task_ptr *first, const task_ptr *last) {
+        m_deque.push_bulk(last - first, [first](std::size_t i) {
+            return to_queued(first[i]);
+        });
+        m_counters.queue_depth(m_deque.size());
     }
 
     task_ptr Worker::try_steal() {
-        // Return nullptr if no Tasks available
-        if (m_deque.empty()) return nullptr;
+        // Stealing from the thief end of the deque
+        Task *stolen = nullptr;
+        if (m_deque.steal(stolen))
+            return from_queued(stolen);
+
+        // Otherwise stealing the oldest injected Task
+        return take_injected(nullptr, 0);
+    }
 
-        // Otherwise remove the Task from the deque
-        task_ptr stolen = m_deque.front();
-        m_deque.pop_front();
+    task_ptr Worker::try_steal_half(Worker &thief) {
+        // Stealing the Task to be executed by the thief
+        Task *stolen = nullptr;
+        if (m_deque.steal(stolen)) {
+            // Moving half of the remaining Tasks to the thief:
+            // Thieves can only claim Tasks one by one, as a
+            // batched CAS on the top index could race with the
+            // owner popping from the bottom without a CAS.
+            std::size_t batch = m_deque.size() / 2;
+            Task *moved = nullptr;
+            for (std::size_t i = 0; i < batch && m_deque.steal(moved); i++) {
+                thief.m_deque.push(moved);
+            }
 
-        return stolen;
+            return from_queued(stolen);
+        }
+
+        // Otherwise moving half of the injected Tasks
+        return take_injected(&thief, 2);
     }
 
-    task_ptr Worker::current_task() const {
+    const task_ptr& Worker::current_task() const {
         return m_current_task;
     }
 
     std::size_t Worker::task_count() const {
-        return m_deque.size();
+        return m_deque.size() + m_injected.size();
+    }
+
+    detail::worker_counters& Worker::counters() {
+        return m_counters;
+    }
+
+    worker_stats Worker::stats() const {
+        return m_counters.snapshot();
+    }
+
+    void Worker::collect_latency(std::map<std::uint32_t, latency_stats> &stats) const {
+        m_latency.collect(stats);
     }
 
     std::thread::id Worker::get_id() const {
         return m_thread_id;
     }
 
+    void Worker::set_owner(WorkerPool *owner, std::size_t index) {
+        m_owner = owner;
+        m_index = index;
+    }
+
+    WorkerPool* Worker::owner() const {
+        return m_owner;
+    }
+
+    std::size_t Worker::index() const {
+        return m_index;
+    }
+
+    Worker* Worker::current() {
+        return s_current_worker;
+    }
+
     void Worker::do_work() {
-        while (!m_deque.empty() || !m_stop_flag) {
-
-            // Check if there is a task available
-            std::unique_lock<Worker> guard(*this);
-            if (!m_deque.empty()) {
-                m_current_task = m_deque.front();
-                m_deque.pop_front();
-            } else {
-                m_current_task = nullptr;
-            }
-            guard.unlock();
+        // Parking on the Dispatcher when idle
+        run(m_idle_policy, [](std::chrono::microseconds timeout,
+                              std::chrono::microseconds idle_time) {
+            return detail::wait_for_work(timeout, idle_time);
+        });
+    }
 
-            // Executing Task
-            if (m_current_task != nullptr) {
-                m_current_task->process();
-            }
-            else if (m_can_steal){
-                // Yielding CPU time to others
-                std::this_thread::yield();
-                std::this_thread::sleep_for(std::chrono::microseconds{1});
-
-                // Choosing a victim
-                worker_ptr victim = detail::choose_victim();
-                if (victim.get() == this) continue;
-
-                // Trying to steal from victim
-                lock_in_order(victim);
-                m_current_task = victim->try_steal();
-                unlock_in_order(victim);
-
-                // Executing stolen task
-                if (m_current_task != nullptr) {
-                    m_current_task->process();
-                }
-            }
+    bool Worker::run_one() {
+        // Finding a Task in the own queues, or stealing one
+        task_ptr task = pop_task();
+        if (task == nullptr && m_can_steal)
+            task = steal_task();
+        if (task == nullptr) return false;
+
+        // Executing it in place of the current Task
+        task_ptr outer = std::move(m_current_task);
+        m_current_task = std::move(task);
+        process_current();
+        m_current_task = std::move(outer);
+        m_counters.executed();
+
+        return true;
+    }
+
+    void Worker::process_current() {
+        if (!detail::tracking_latency()) {
+            m_current_task->process();
+            return;
         }
+
+        // Timing the execution, the Task is kept alive by m_current_task
+        std::uint32_t tag     = m_current_task->m_tag;
+        std::int64_t  queued  = m_current_task->m_enqueued;
+        std::int64_t  started = detail::latency_clock();
+        m_current_task->process();
+        m_latency.record(tag, queued, started, detail::latency_clock());
+    }
+
+    task_ptr Worker::steal_task() {
+        // Choosing a victim
+        Worker *victim = choose_victim();
+        if (victim == nullptr || victim == this) return nullptr;
+
+        // Trying to steal from victim
+        task_ptr stolen = m_steal_mode == steal_mode::half ? victim->try_steal_half(*this)
+                                                           : victim->try_steal();
+
+        // Counting failures to widen the search
+        if (stolen == nullptr) m_failed_steals++;
+        else m_failed_steals = 0;
+        m_counters.steal(stolen != nullptr);
+        if (stolen != nullptr) detail::trace(trace_event::steal, stolen->get_id());
+        return stolen;
+    }
+
+    Worker* Worker::choose_victim() {
+        if (m_victims.empty()) return nullptr;
+
+        // Trying each SMT sibling once
+        std::size_t failures = m_failed_steals;
+        if (failures < m_sibling_count) return m_victims[failures];
+        failures -= m_sibling_count;
+
+        // Sweeping the workers in the same domain once,
+        // starting at a random one
+        if (failures < m_neighbour_count) {
+            if (failures == 0) m_sweep_start = m_rng.below(m_neighbour_count);
+            return m_victims[m_sibling_count + (m_sweep_start + failures) % m_neighbour_count];
+        }
+        failures -= m_neighbour_count;
+
+        // Sweeping all workers after repeated failures, each
+        // victim visited once per round from a random start
+        std::size_t position = failures % m_victims.size();
+        if (position == 0) m_sweep_start = m_rng.below(m_victims.size());
+        return m_victims[(m_sweep_start + position) % m_victims.size()];
+    }
+
+    task_ptr Worker::pop_task() {
+        // Popping from the owner end of the deque without locking
+        Task *popped = nullptr;
+        if (m_deque.pop(popped))
+            return from_queued(popped);
+
+        // Draining the injection queue into the deque
+        return take_injected(this, 1);
+    }
+
+    task_ptr Worker::take_injected(Worker *receiver, std::size_t share) {
+        // Taking the oldest Task and the share of the rest to be moved
+        std::size_t rest  = m_injected.size();
+        rest = rest == 0 ? 0 : rest - 1;
+        std::size_t moved = share == 0 ? 0 : rest / share;
+        Task *task = m_injected.take(moved + 1);
+        if (task == nullptr) return nullptr;
+
+        // Moving the newer Tasks into the receiver's deque,
+        // the oldest of them ending up at the owner end
+        std::size_t count = 0;
+        while (InjectionQueue::next(task) != nullptr) {
+            Task *next = InjectionQueue::next(task);
+            receiver->m_deque.push(task);
+            task = next;
+            count++;
+        }
+        if (count > 0) receiver->m_counters.queue_depth(receiver->m_deque.size() + 1);
+
+        return from_queued(task);
+    }
+
+    bool Worker::empty() const {
+        return m_deque.empty() && m_injected.size() == 0;
+    }
+
+    Task* Worker::to_queued(task_ptr task) {
+        if (detail::tracking_latency())
+            task->m_enqueued = detail::latency_clock();
+        return task.detach();
+    }
+
+    task_ptr Worker::from_queued(Task *task) {
+        return task_ptr::adopt(task);
     }
 
 } // namespace tdl
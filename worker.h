@@ -2,137 +2,547 @@
 #ifndef WORKER_H
 #define WORKER_H
 
-#include <thread>
-#include <deque>
 #include <mutex>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <chrono>
 
+#include "deque.h"
+#include "injection.h"
+#include "rng.h"
+#include "stats.h"
+#include "latency.h"
+#include "trace.h"
 #include "task.h"
 #include "types.h"
 
 namespace tdl {
 
+    /**
+     * @brief Workers can steal in two modes: single and half.
+     *        With steal_mode::single a thief takes one Task per
+     *        steal, with steal_mode::half it also moves half of
+     *        the victim's remaining Tasks into it's own deque.
+     */
+    enum class steal_mode { single, half };
+
+    /**
+     * @brief The idle_policy struct configures how workers
+     *        without Tasks wait for work. An idle worker makes
+     *        spin_count steal attempts (yielding in between),
+     *        then parks until new work is submitted or spawned,
+     *        or until park_timeout expires. A worker idle for
+     *        retire_timeout exits it's thread, which is started
+     *        again when Tasks are submitted to the worker (zero
+     *        disables retirement).
+     */
+    struct idle_policy {
+        std::size_t                 spin_count     = 64;
+        std::chrono::microseconds   park_timeout   = std::chrono::milliseconds(100);
+        std::chrono::microseconds   retire_timeout = std::chrono::microseconds::zero();
+    };
+
+    /**
+     * @brief The static_idle_policy struct is the compile-time
+     *        counterpart of tdl::idle_policy, used as the idle
+     *        policy of tdl::basic_pool. The parameters become
+     *        constants of the worker loop.
+     */
+    template <std::size_t SpinCount = 64, std::size_t ParkMicroseconds = 100000>
+    struct static_idle_policy {
+        static constexpr std::size_t                spin_count   = SpinCount;
+        static constexpr std::chrono::microseconds  park_timeout = std::chrono::microseconds(ParkMicroseconds);
+    };
+
+    template <std::size_t SpinCount, std::size_t ParkMicroseconds>
+    constexpr std::size_t static_idle_policy<SpinCount, ParkMicroseconds>::spin_count;
+
+    template <std::size_t SpinCount, std::size_t ParkMicroseconds>
+    constexpr std::chrono::microseconds static_idle_policy<SpinCount, ParkMicroseconds>::park_timeout;
+
+    /**
+     * @brief   The WorkerPool class is the interface of the pools
+     *          owning Workers: the Dispatcher behind the global
+     *          functions, and tdl::basic_pool.
+     * @details Work created inside a Task (spawned children,
+     *          pushed continuations and successors, the range Tasks
+     *          of tdl::parallel_for()) is routed to the owner of the
+     *          calling worker (see tdl::detail::current_pool()), so
+     *          it stays in the pool executing the Task.
+     */
+    class WorkerPool {
+    public:
+        virtual ~WorkerPool() = default;
+
+        /** Submits a Task to a worker selected by the pool. */
+        virtual void submit(const task_ptr &task) = 0;
+
+        /** Submits a batch of Tasks to the workers of the pool. */
+        virtual void submit_bulk(const std::vector<task_ptr> &tasks) = 0;
+
+        /** Spawns a Task as a child of the calling Task. */
+        virtual void spawn(const task_ptr &task) = 0;
+
+        /** Spawns a Task as a child of the supplied parent. */
+        virtual void spawn(const task_ptr &task, const task_ptr &parent) = 0;
+
+        /** Spawns a batch of Tasks as children of the calling Task. */
+        virtual void spawn_bulk(const std::vector<task_ptr> &tasks) = 0;
+
+        /** Submits a Task to the worker with the given index. */
+        virtual void submit_to(std::size_t index, const task_ptr &task) = 0;
+
+        /** Pushes a ready Task to the calling worker, or submits it. */
+        virtual void push_task(const task_ptr &task) = 0;
+
+        /**
+         * @brief Returns the index of the calling worker in the pool,
+         *        or tdl::detail::no_worker if it is not one of them.
+         */
+        virtual std::size_t current_worker_index() const = 0;
+
+        /** Returns the number of workers Tasks are scheduled to. */
+        virtual std::size_t worker_count() const = 0;
+    };
+
     /**
      * @brief The Worker class is responsible for managing
      *        a worker-thread. Tasks are pushed to the worker
      *        by calling push_task() and submit(). When started,
      *        workers begin executing their do_work() method in
      *        a separate thread.
+     *        Tasks pushed by the worker itself are kept in a
+     *        lock-free work-stealing deque, while Tasks submitted
+     *        from other threads are placed into a lock-free
+     *        injection queue, drained by the worker when it's
+     *        deque is empty.
      */
     class Worker final {
     public:
         /** Constructs a Worker. */
-        Worker(bool is_main_worker);
+        Worker(bool is_main_worker,
+               steal_mode mode = steal_mode::half,
+               idle_policy idle = idle_policy());
+
+        /** Releases the Tasks left in the queues. */
+        ~Worker();
 
         /**
          * @brief Starts the Worker's thread which
          *        executes do_work().
+         * @param Logical CPU to pin the thread to, or -1
+         *        to leave it unpinned. (default: -1)
          */
-        void start();
+        void start(int cpu = -1);
 
         /**
-         * @brief Signals the do_work() method to
-         *        stop execution when all Tasks are
-         *        finished.
+         * @brief Starts the Worker's thread which executes run()
+         *        instead of do_work(). Used by tdl::basic_pool.
+         * @param The idle policy (see tdl::static_idle_policy).
+         * @param Function parking the worker, called with the
+         *        park timeout of the idle policy.
+         * @param Logical CPU to pin the thread to, or -1
+         *        to leave it unpinned. (default: -1)
          */
-        void stop();
+        template <class IdlePolicy, class Park>
+        void start(IdlePolicy idle, Park park, int cpu = -1) {
+            m_cpu = cpu;
+            m_running = true;
+            launch(std::thread([this, idle, park]() { run(idle, park); }), cpu);
+        }
 
         /**
-         * @brief Joins the Worker's thread and block
-         *        until do_work() finishes execution.
+         * @brief Sets the logical CPU the thread is pinned to
+         *        when started by activate(), or -1 to leave it
+         *        unpinned. Must be called before activate().
          */
-        void join();
+        void set_cpu(int cpu);
 
         /**
-         * @brief Locks the mutex guarding the deque.
+         * @brief   Starts the Worker's thread executing do_work()
+         *          if it is not running (not started yet, or
+         *          retired). Returns true if the thread was started.
+         * @details Called after submitting Tasks to the worker. May
+         *          be called from any thread; of concurrent callers
+         *          only one starts the thread. The thread of a retired
+         *          worker is joined before it is replaced. Fails once
+         *          join() was called, so no thread is started after
+         *          the final join.
          */
-        void lock();
+        bool activate();
 
         /**
-         * @brief Unlocks the mutex guarding the deque.
+         * @brief   Stops the Worker's thread after do_work() returns,
+         *          unless Tasks were submitted meanwhile. Returns true
+         *          if the thread must exit.
+         * @details Must only be called from the worker's own thread,
+         *          when it's queues are empty. A Task submitted during
+         *          retirement is either seen by the final check, or
+         *          the submitter's activate() starts a new thread.
          */
-        void unlock();
+        bool retire();
 
         /**
-         * @brief Locks this Worker and the other in the
-         *        order of their thread IDs. Used during
-         *        work-stealing to avoid deadlocking when
-         *        two workers are trying to steal from each
-         *        other at the same time.
+         * @brief Returns true if the Worker's thread is running.
+         */
+        bool running() const;
+
+        /**
+         * @brief   Sets the workers to steal from, ordered by
+         *          distance: the workers on SMT siblings first,
+         *          the workers in the same cache or NUMA domain
+         *          next, and remote workers last. Must be called
+         *          before start().
+         * @details Without siblings and neighbours, the victims are
+         *          swept in random order. Without victims the worker
+         *          does not steal.
+         * @param   The victims, ordered by distance.
+         * @param   The number of victims on SMT siblings.
+         * @param   The number of victims in the same domain.
+         */
+        void set_victims(std::vector<Worker*> victims,
+                         std::size_t siblings,
+                         std::size_t neighbours);
+
+        /**
+         * @brief Signals the do_work() method to
+         *        stop execution when all Tasks are
+         *        finished.
          */
-        void lock_in_order(worker_ptr other);
+        void stop();
 
         /**
-         * @brief Unlocks this worker and the other in the
-         *        order of their thread IDs. Used during
-         *        work-stealing to avoid deadlocking when
-         *        two workers are trying to steal from each
-         *        other at the same time.
+         * @brief Joins the Worker's thread and block
+         *        until do_work() finishes execution.
+         *        Later calls to activate() fail.
          */
-        void unlock_in_order(worker_ptr other);
+        void join();
 
         /**
-         * @brief Pushes a Task to the back of the deque.
-         *        Used by the scheduler to push new Tasks
-         *        to the worker.
+         * @brief Pushes a Task to the injection queue. Used by
+         *        the scheduler to push new Tasks to the worker.
+         *        May be called from any thread.
          * @param Task to submit for the worker.
          */
-        void submit(task_ptr task);
+        void submit(const task_ptr &task);
 
         /**
-         * @brief Pushes a Task to the front of the deque.
+         * @brief Pushes a batch of Tasks to the injection queue
+         *        in a single operation. May be called from any
+         *        thread.
+         * @param Pointer to the first Task of the batch.
+         * @param Pointer past the last Task of the batch.
+         */
+        void submit(const task_ptr *first, const task_ptr *last);
+
+        /**
+         * @brief Pushes a Task to the owner end of the deque.
          *        Used by the worker to push child tasks
          *        and continuations of the currently
-         *        executing or finishing Task.
+         *        executing or finishing Task. Must only be
+         *        called from the worker's own thread.
          * @param Task to push to the worker.
          */
-        void push_task(task_ptr task);
+        void push_task(const task_ptr &task);
+
+        /**
+         * @brief Pushes a batch of Tasks to the owner end of the
+         *        deque in a single operation. Must only be called
+         *        from the worker's own thread.
+         * @param Pointer to the first Task of the batch.
+         * @param Pointer past the last Task of the batch.
+         */
+        void push_tasks(const task_ptr *first, const task_ptr *last);
 
         /**
          * @brief   Attempts to steal a Task from the worker,
-         *          by trying to pop from the front of the
-         *          deque. Returns the stolen tdl::task_ptr
-         *          if successful, or nullptr otherwise.
-         * @details The try_steal() method itself does not
-         *          attempts to acquire a lock on the deque,
-         *          and the caller must ensure the proper
-         *          synchronisation.
+         *          by stealing from the thief end of the deque,
+         *          or the oldest Task of the injection queue.
+         *          Returns the stolen tdl::task_ptr if
+         *          successful, or nullptr otherwise.
+         * @details Stealing is lock-free. The injection queue
+         *          is taken as a whole, and the Tasks not stolen
+         *          are pushed back in one operation. The thief's
+         *          own queues are untouched.
          */
         task_ptr try_steal();
 
+        /**
+         * @brief   Attempts to steal a batch of Tasks from the
+         *          worker. The first stolen Task is returned for
+         *          execution (or nullptr if none), and up to half
+         *          of the remaining Tasks are moved into the deque
+         *          of the thief in the same operation.
+         * @details Must only be called from the thief's thread,
+         *          as the thief's deque is pushed to as owner.
+         * @param   The Worker stealing the Tasks.
+         */
+        task_ptr try_steal_half(Worker &thief);
+
         /**
          * @brief Returns a tdl::task_ptr to the
          *        currently executing Task.
          */
-        task_ptr current_task() const;
+        const task_ptr& current_task() const;
 
         /**
-         * @brief Returns the number of Tasks in the
-         *        Worker's deque.
+         * @brief Returns the (approximate) number of Tasks
+         *        in the Worker's queues. Only atomic counters
+         *        (the deque indices and the injection queue size)
+         *        are read, so it may be called from any thread.
+         *        Used by schedulers as the load of the worker.
          */
         std::size_t task_count() const;
 
+        /**
+         * @brief Returns the counters of the worker. Used by the
+         *        Dispatcher to count spawned Tasks.
+         */
+        detail::worker_counters& counters();
+
+        /**
+         * @brief Returns a snapshot of the worker's counters.
+         *        May be called from any thread.
+         */
+        worker_stats stats() const;
+
+        /**
+         * @brief Merges the latency histograms of the worker into
+         *        the statistics of each Task tag (see
+         *        tdl::set_latency_tracking()). May be called from
+         *        any thread.
+         */
+        void collect_latency(std::map<std::uint32_t, latency_stats> &stats) const;
+
         /**
          * @brief Returns the ID of the worker.
          *       (Same as the worker's thread ID)
          */
         std::thread::id get_id() const;
 
+        /**
+         * @brief Sets the pool owning the worker, which receives
+         *        the work created by it's Tasks. Must be called
+         *        before the worker starts.
+         * @param owner Pool owning the worker
+         * @param index Index of the worker in the pool, or
+         *        tdl::detail::no_worker if it is not one of
+         *        the pool's indexed workers
+         */
+        void set_owner(WorkerPool *owner, std::size_t index);
+
+        /**
+         * @brief Returns the pool owning the worker.
+         */
+        WorkerPool* owner() const;
+
+        /**
+         * @brief Returns the index of the worker in it's owning
+         *        pool, or tdl::detail::no_worker if it has none.
+         */
+        std::size_t index() const;
+
+        /**
+         * @brief Returns the Worker executing do_work() on
+         *        the calling thread, or nullptr if there is
+         *        none. The Worker is registered in a thread
+         *        local slot for the duration of do_work().
+         */
+        static Worker* current();
+
+        /**
+         * @brief   Executes a single Task from the Worker's queues,
+         *          or stolen from another worker. Returns false if
+         *          no Task was found.
+         * @details Used to keep the worker busy while it waits for
+         *          something inside a Task. Must only be called from
+         *          the worker's own thread. The current Task is
+         *          restored after execution.
+         */
+        bool run_one();
+
         /**
          * @brief The main method of the Worker.
          *        Repeatedly tries to pop a Task
          *        from it's internal queue, and
-         *        executes it.
+         *        executes it. When out of Tasks,
+         *        steals or parks according to the
+         *        worker's idle policy.
          */
         void do_work();
 
+        /**
+         * @brief The main loop of the Worker (see do_work()),
+         *        with the idle policy and the parking function
+         *        as template parameters, inlined into the loop.
+         * @param The idle policy, providing spin_count and
+         *        park_timeout.
+         * @param Function parking the worker until new work
+         *        is published, called with the park timeout and
+         *        the time the worker has been idle. Returns false
+         *        if the worker retired (see retire()).
+         */
+        template <class IdlePolicy, class Park>
+        void run(const IdlePolicy &idle, Park &&park) {
+            std::size_t failed_steals = 0;
+            bool idle_parked = false;
+            std::chrono::steady_clock::time_point idle_since;
+
+            // Registering the Worker for the calling thread
+            Worker *previous_worker = s_current_worker;
+            s_current_worker = this;
+            m_counters.start();
+
+            while (!empty() || !m_stop_flag) {
+
+                // Check if there is a task available
+                m_current_task = pop_task();
+
+                // Executing Task
+                if (m_current_task != nullptr) {
+                    idle_parked = false;
+                    m_counters.busy();
+                    process_current();
+                    m_counters.executed();
+                }
+                else if (m_can_steal){
+                    // Trying to steal from a victim
+                    m_current_task = steal_task();
+
+                    // Executing stolen task
+                    if (m_current_task != nullptr) {
+                        failed_steals = 0;
+                        idle_parked = false;
+                        m_counters.busy();
+                        process_current();
+                        m_counters.executed();
+                        continue;
+                    }
+
+                    // Spinning or parking without Tasks
+                    m_counters.idle();
+                    if (++failed_steals < idle.spin_count) {
+                        // Yielding CPU time to others while spinning
+                        std::this_thread::yield();
+                    }
+                    else {
+                        // Parking until new work is published
+                        failed_steals = 0;
+                        m_failed_steals = 0;
+                        auto now = std::chrono::steady_clock::now();
+                        if (!idle_parked) {
+                            idle_parked = true;
+                            idle_since = now;
+                        }
+
+                        // Exiting if the worker retired
+                        auto idle_time = std::chrono::duration_cast<std::chrono::microseconds>(now - idle_since);
+                        detail::trace(trace_event::park);
+                        bool parked = park(idle.park_timeout, idle_time);
+                        detail::trace(trace_event::unpark);
+                        if (!parked) break;
+                    }
+                }
+            }
+
+            // Unregistering the Worker
+            m_counters.stop();
+            s_current_worker = previous_worker;
+        }
+
     private:
-        bool                    m_can_steal;
-        volatile bool           m_stop_flag;
-        std::mutex              m_deque_guard;
-        std::deque<task_ptr>    m_deque;
-        std::thread             m_thread;
-        std::thread::id         m_thread_id;
-        task_ptr                m_current_task;
+        bool                        m_can_steal;
+        steal_mode                  m_steal_mode;
+        idle_policy                 m_idle_policy;
+        volatile bool               m_stop_flag;
+        std::atomic<bool>           m_running;
+        int                         m_cpu;
+        WorkerPool                 *m_owner;
+        std::size_t                 m_index;
+        WorkStealingDeque<Task*>    m_deque;
+        InjectionQueue              m_injected;
+        std::mutex                  m_thread_mutex;
+        bool                        m_joined;
+        std::thread                 m_thread;
+        std::thread::id             m_thread_id;
+        task_ptr                    m_current_task;
+        std::vector<Worker*>        m_victims;
+        std::size_t                 m_sibling_count;
+        std::size_t                 m_neighbour_count;
+        std::size_t                 m_failed_steals;
+        std::size_t                 m_sweep_start;
+        detail::fast_rng            m_rng;
+        detail::worker_counters     m_counters;
+        detail::LatencyRecorder     m_latency;
+
+        /** The Worker running on the calling thread. */
+        static thread_local Worker* s_current_worker;
+
+        /**
+         * @brief Pops the next Task to execute, trying the
+         *        deque first and the injection queue next.
+         *        Returns nullptr if both are empty.
+         */
+        task_ptr pop_task();
+
+        /**
+         * @brief Takes ownership of the started thread, and pins
+         *        it to the logical CPU unless cpu is negative.
+         *        Called by activate() with m_thread_mutex held, or
+         *        by start() before the worker is shared.
+         */
+        void launch(std::thread thread, int cpu);
+
+        /**
+         * @brief  Takes the oldest Task of the injection queue for
+         *         execution, and moves the 1/share part of the rest
+         *         that follows it into the deque of the receiver.
+         *         The newer Tasks stay in the queue. Must be called
+         *         from the receiver's thread.
+         * @param  The Worker receiving the moved Tasks (may be
+         *         nullptr if share is 0).
+         * @param  The divisor of the moved part (0 moves nothing).
+         * @return The oldest Task, or nullptr if none was taken.
+         */
+        task_ptr take_injected(Worker *receiver, std::size_t share);
+
+        /**
+         * @brief Executes the current Task, recording it's queueing
+         *        delay and execution time if latencies are tracked.
+         */
+        void process_current();
+
+        /**
+         * @brief Attempts to steal a Task from the next victim
+         *        (see choose_victim()) according to the steal mode. Returns nullptr
+         *        if no Task was stolen.
+         */
+        task_ptr steal_task();
+
+        /**
+         * @brief Chooses the next victim according to the steal
+         *        failures since the last success: each sibling
+         *        once, then each neighbour once, then rounds over
+         *        all victims. Sweeps start at a random victim, so
+         *        a failed victim is not picked again in the same
+         *        round. Returns nullptr if there are no victims.
+         */
+        Worker* choose_victim();
+
+        /**
+         * @brief Returns true if both queues are empty.
+         */
+        bool empty() const;
+
+        /**
+         * @brief Converts between a tdl::task_ptr and the raw
+         *        pointer stored in the deque. While queued, the
+         *        deque owns one reference to the Task. Queued
+         *        Tasks are timestamped while latencies are tracked.
+         */
+        static Task*    to_queued(task_ptr task);
+        static task_ptr from_queued(Task *task);
     };
 
 } // namespace tdl